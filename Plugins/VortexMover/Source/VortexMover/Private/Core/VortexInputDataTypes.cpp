@@ -3,6 +3,127 @@
 
 #include "Core/VortexInputDataTypes.h"
 
+#include "HAL/IConsoleManager.h"
+#include "Net/VortexInputNetChannel.h"
+#include "Net/VortexNetBitAccounting.h"
+#include "UObject/CoreNet.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverLogChannels.h"
+#include "VortexMoverStats.h"
+#include <atomic>
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reconciles: MoveInput"), STAT_VortexReconcileMoveInput, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reconciles: OrientationInput"), STAT_VortexReconcileOrientationInput, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reconciles: ControlRotation"), STAT_VortexReconcileControlRotation, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Reconciles: Buttons"), STAT_VortexReconcileButtons, STATGROUP_VortexMover);
+
+namespace
+{
+	// Which field made ShouldReconcile fail, a single reconcile can count towards several
+	enum class EReconcileReason : uint8
+	{
+		MoveInput,
+		OrientationInput,
+		ControlRotation,
+		Buttons,
+
+		Num
+	};
+
+	const TCHAR* ReconcileReasonNames[] = { TEXT("MoveInput"), TEXT("OrientationInput"), TEXT("ControlRotation"), TEXT("Buttons") };
+	static_assert(UE_ARRAY_COUNT(ReconcileReasonNames) == static_cast<int32>(EReconcileReason::Num), "Missing reconcile reason name");
+
+	// ShouldReconcile may run on the sim thread
+	std::atomic<uint32> GReconcileCounts[static_cast<int32>(EReconcileReason::Num)];
+	std::atomic<uint32> GReconcileChecks;
+
+	void RecordReconcileReason(EReconcileReason Reason)
+	{
+		GReconcileCounts[static_cast<int32>(Reason)].fetch_add(1, std::memory_order_relaxed);
+
+		switch (Reason)
+		{
+		case EReconcileReason::MoveInput:        INC_DWORD_STAT(STAT_VortexReconcileMoveInput); break;
+		case EReconcileReason::OrientationInput: INC_DWORD_STAT(STAT_VortexReconcileOrientationInput); break;
+		case EReconcileReason::ControlRotation:  INC_DWORD_STAT(STAT_VortexReconcileControlRotation); break;
+		case EReconcileReason::Buttons:          INC_DWORD_STAT(STAT_VortexReconcileButtons); break;
+		default: break;
+		}
+	}
+
+	void LogReconcileStats(const TArray<FString>& Args)
+	{
+		const uint32 Checks = GReconcileChecks.load(std::memory_order_relaxed);
+		UE_LOG(LogVortexMover, Display, TEXT("FVortexInputCmd reconcile checks: %u"), Checks);
+		for (int32 Index = 0; Index < static_cast<int32>(EReconcileReason::Num); ++Index)
+		{
+			const uint32 Count = GReconcileCounts[Index].load(std::memory_order_relaxed);
+			UE_LOG(LogVortexMover, Display, TEXT("  %-16s %u (%.2f%%)"), ReconcileReasonNames[Index], Count, Checks > 0 ? 100.0 * Count / Checks : 0.0);
+		}
+
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+		{
+			GReconcileChecks.store(0, std::memory_order_relaxed);
+			for (std::atomic<uint32>& Count : GReconcileCounts)
+			{
+				Count.store(0, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	FAutoConsoleCommand CmdVortexReconcileStats(
+		TEXT("vortex.reconcile.Stats"),
+		TEXT("Logs which FVortexInputCmd fields caused reconciles. Pass 'reset' to clear the counters after logging."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&LogReconcileStats));
+
+	// Fields reported by vortex.debug.NetBits, redundant resends count towards the fields they repeat
+	const FVortexNetBitField NetBitsTotal(TEXT("VortexInputCmd"), TEXT("Total"));
+	const FVortexNetBitField NetBitsMoveInput(TEXT("VortexInputCmd"), TEXT("MoveInput"));
+	const FVortexNetBitField NetBitsOrientationInput(TEXT("VortexInputCmd"), TEXT("OrientationInput"));
+	const FVortexNetBitField NetBitsControlRotation(TEXT("VortexInputCmd"), TEXT("ControlRotation"));
+	const FVortexNetBitField NetBitsFlags(TEXT("VortexInputCmd"), TEXT("Flags"));
+
+	// Yaw covers the full circle, wraps at 2^Bits
+	uint32 QuantizeYaw(double Yaw, int32 Bits)
+	{
+		const uint32 Steps = 1u << Bits;
+		return static_cast<uint32>(FMath::RoundToInt64(FRotator::ClampAxis(Yaw) * Steps / 360.0)) & (Steps - 1);
+	}
+
+	double DequantizeYaw(uint32 Value, int32 Bits)
+	{
+		return Value * 360.0 / (1u << Bits);
+	}
+
+	// Pawns never look past straight up/down, so pitch only needs half the range
+	uint32 QuantizePitch(double Pitch, int32 Bits)
+	{
+		const uint32 MaxValue = (1u << Bits) - 1;
+		const double Clamped = FMath::Clamp(FRotator::NormalizeAxis(Pitch), -90.0, 90.0);
+		return static_cast<uint32>(FMath::RoundToInt64((Clamped + 90.0) / 180.0 * MaxValue));
+	}
+
+	double DequantizePitch(uint32 Value, int32 Bits)
+	{
+		const uint32 MaxValue = (1u << Bits) - 1;
+		return FRotator::ClampAxis(Value * 180.0 / MaxValue - 90.0);
+	}
+}
+
+namespace VortexInputWireFormat
+{
+	EVortexInputWireFormat GetActiveFormat()
+	{
+		const int32 Format = VortexMoverCVars::GetInputWireFormat();
+		return Format == static_cast<int32>(EVortexInputWireFormat::Legacy) ? EVortexInputWireFormat::Legacy : EVortexInputWireFormat::Compact;
+	}
+
+	int32 GetActiveRotationBits()
+	{
+		return FMath::Clamp(VortexMoverCVars::GetInputRotationBits(), MinRotationBits, MaxRotationBits);
+	}
+}
+
 void FVortexInputCmd::SetMoveInput(const FVector& InMoveInput)
 {
 	// like the examples, limit the precision that we store, so that it matches what is NetSerialized (2 decimal place of precision).
@@ -11,8 +132,30 @@ void FVortexInputCmd::SetMoveInput(const FVector& InMoveInput)
 	MoveInput.Z = FMath::RoundToFloat(InMoveInput.Z * 100.0) / 100.0;
 }
 
+void FVortexInputCmd::SetControlRotation(const FRotator& InControlRotation)
+{
+	// Same as SetMoveInput: store what the receiver will decode so both sides agree. Changes to this also need to be reflected in SerializeFields.
+	if (VortexInputWireFormat::GetActiveFormat() == EVortexInputWireFormat::Compact)
+	{
+		const int32 Bits = VortexInputWireFormat::GetActiveRotationBits();
+		ControlRotation.Pitch = DequantizePitch(QuantizePitch(InControlRotation.Pitch, Bits), Bits);
+		ControlRotation.Yaw = DequantizeYaw(QuantizeYaw(InControlRotation.Yaw, Bits), Bits);
+		ControlRotation.Roll = 0.0;
+	}
+	else
+	{
+		ControlRotation.Pitch = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(InControlRotation.Pitch));
+		ControlRotation.Yaw = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(InControlRotation.Yaw));
+		ControlRotation.Roll = FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(InControlRotation.Roll));
+	}
+
+	// Facing intent, the compact layout rebuilds this on receive instead of sending it
+	OrientationInput = ControlRotation.Vector().GetSafeNormal();
+}
+
 FMoverDataStructBase* FVortexInputCmd::Clone() const
 {
+	// Pooled, see VORTEX_POOLED_DATA_STRUCT
 	FVortexInputCmd* CopyPtr = new FVortexInputCmd(*this);
 	return CopyPtr;
 }
@@ -21,16 +164,120 @@ bool FVortexInputCmd::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuc
 {
 	Super::NetSerialize(Ar, Map, bOutSuccess);
 
-	SerializePackedVector<100, 30>(MoveInput, Ar); // Changes to this also need to be reflected in SetMoveInput
-	SerializeFixedVector<1, 16>(OrientationInput, Ar);
-	ControlRotation.SerializeCompressedShort(Ar);
+	FVortexNetBitScope TotalBits(Ar, Map, NetBitsTotal);
+
+	if (Ar.IsLoading())
+	{
+		// Received commands never upload themselves again
+		NetStreamId = 0;
+		NetChannelId = 0;
+	}
+
+	// The layout is configured, not sent: the legacy one stays readable by builds from before the wire formats
+	const EVortexInputWireFormat Format = VortexInputWireFormat::GetActiveFormat();
+	if (Format == EVortexInputWireFormat::Legacy)
+	{
+		SerializeFields(Ar, EVortexInputField::All, Format, Map);
+		bOutSuccess = !Ar.IsError();
+		return bOutSuccess;
+	}
+
+	// Uploads from the owning client go through the sequenced input stream so they can be delta compressed, everything else
+	// (server to simulated proxies, commands of pawns without a stream yet) is sent in full. Mover passes no package map,
+	// so the producer's stream stamp is what tells them apart.
+	uint8 bSequenced = Ar.IsSaving() && NetStreamId != 0 ? 1 : 0;
+	Ar.SerializeBits(&bSequenced, 1);
+
+	if (bSequenced)
+	{
+		bOutSuccess = VortexInputNet::SerializeSequenced(*this, Ar, Map, Format);
+		return bOutSuccess;
+	}
+
+	SerializeFields(Ar, EVortexInputField::All, Format, Map);
+
+	bOutSuccess = true;
+	return true;
+}
+
+uint8 FVortexInputCmd::GetChangedFields(const FVortexInputCmd& Baseline) const
+{
+	uint8 Changed = EVortexInputField::None;
+	Changed |= MoveInput != Baseline.MoveInput ? EVortexInputField::MoveInput : 0;
+	Changed |= OrientationInput != Baseline.OrientationInput ? EVortexInputField::OrientationInput : 0;
+	Changed |= ControlRotation != Baseline.ControlRotation ? EVortexInputField::ControlRotation : 0;
+	return Changed;
+}
+
+bool FVortexInputCmd::HasSameWireValues(const FVortexInputCmd& Other) const
+{
+	return GetChangedFields(Other) == EVortexInputField::None
+		&& bJumpPressed == Other.bJumpPressed
+		&& bJumpJustPressed == Other.bJumpJustPressed
+		&& bCrouchPressed == Other.bCrouchPressed;
+}
+
+void FVortexInputCmd::SerializeFields(FArchive& Ar, uint8 FieldMask, EVortexInputWireFormat Format, const UPackageMap* Map)
+{
+	if (FieldMask & EVortexInputField::MoveInput)
+	{
+		FVortexNetBitScope FieldBits(Ar, Map, NetBitsMoveInput);
+		SerializePackedVector<100, 30>(MoveInput, Ar); // Changes to this also need to be reflected in SetMoveInput
+	}
+
+	if (Format == EVortexInputWireFormat::Legacy)
+	{
+		if (FieldMask & EVortexInputField::OrientationInput)
+		{
+			FVortexNetBitScope FieldBits(Ar, Map, NetBitsOrientationInput);
+			SerializeFixedVector<1, 16>(OrientationInput, Ar);
+		}
+		if (FieldMask & EVortexInputField::ControlRotation)
+		{
+			FVortexNetBitScope FieldBits(Ar, Map, NetBitsControlRotation);
+			ControlRotation.SerializeCompressedShort(Ar);
+		}
+	}
+	else if (FieldMask & EVortexInputField::ControlRotation)
+	{
+		FVortexNetBitScope FieldBits(Ar, Map, NetBitsControlRotation);
 
+		// Precision travels with the rotation so sender and receiver never need matching config
+		uint8 BitsMinusOne = static_cast<uint8>(VortexInputWireFormat::GetActiveRotationBits() - 1);
+		Ar.SerializeBits(&BitsMinusOne, 4);
+		const int32 Bits = BitsMinusOne + 1;
+		if (Bits < VortexInputWireFormat::MinRotationBits)
+		{
+			Ar.SetError();
+			return;
+		}
+
+		uint32 Pitch = Ar.IsSaving() ? QuantizePitch(ControlRotation.Pitch, Bits) : 0;
+		uint32 Yaw = Ar.IsSaving() ? QuantizeYaw(ControlRotation.Yaw, Bits) : 0;
+		Ar.SerializeBits(&Pitch, Bits);
+		Ar.SerializeBits(&Yaw, Bits);
+
+		if (Ar.IsLoading())
+		{
+			ControlRotation = FRotator(DequantizePitch(Pitch, Bits), DequantizeYaw(Yaw, Bits), 0.0);
+			OrientationInput = ControlRotation.Vector().GetSafeNormal();
+		}
+	}
+
+	FVortexNetBitScope FlagBits(Ar, Map, NetBitsFlags);
 	Ar.SerializeBits(&bJumpPressed, 1);
 	Ar.SerializeBits(&bJumpJustPressed, 1);
 	Ar.SerializeBits(&bCrouchPressed, 1);
+}
 
-	bOutSuccess = true;
-	return true;
+int64 FVortexInputCmd::GetSerializedBitCount(EVortexInputWireFormat Format) const
+{
+	FNetBitWriter Writer(nullptr, 512);
+	FVortexInputCmd Copy(*this);
+	Copy.SerializeFields(Writer, EVortexInputField::All, Format);
+
+	// The compact layout adds the sequenced stream bit
+	return (Format == EVortexInputWireFormat::Compact ? 1 : 0) + Writer.GetNumBits();
 }
 
 void FVortexInputCmd::ToString(FAnsiStringBuilderBase& Out) const
@@ -41,12 +288,46 @@ void FVortexInputCmd::ToString(FAnsiStringBuilderBase& Out) const
 	Out.Appendf("OrientationInput: X=%.2f Y=%.2f Z=%.2f\n", OrientationInput.X, OrientationInput.Y, OrientationInput.Z);
 	Out.Appendf("ControlRot: Pitch=%.2f Yaw=%.2f Roll=%.2f\n", ControlRotation.Pitch, ControlRotation.Yaw, ControlRotation.Roll);
 	Out.Appendf("bJumpPressed: %d bJumpJustPressed: %d bCrouchPressed: %d\n", bJumpPressed ? 1 : 0, bJumpJustPressed ? 1 : 0, bCrouchPressed ? 1 : 0);
+	Out.Appendf("MergedFrames: %d\n", MergedFrames);
 }
 
 bool FVortexInputCmd::ShouldReconcile(const FMoverDataStructBase& AuthorityState) const
 {
 	const FVortexInputCmd& TypedAuthority = static_cast<const FVortexInputCmd&>(AuthorityState);
-	return *this != TypedAuthority;
+	GReconcileChecks.fetch_add(1, std::memory_order_relaxed);
+
+	// Quantization and interpolation leave differences nobody can see, only reconcile beyond the configured tolerances
+	const double MoveTolerance = FMath::Max(VortexMoverCVars::GetReconcileMoveInputTolerance(), 0.0f);
+	const double AngleTolerance = FMath::Max(VortexMoverCVars::GetReconcileAngleTolerance(), 0.0f);
+
+	// Chord length between unit vectors that are AngleTolerance apart
+	const double OrientationTolerance = 2.0 * FMath::Sin(FMath::DegreesToRadians(AngleTolerance) * 0.5);
+
+	bool bShouldReconcile = false;
+	if (!MoveInput.Equals(TypedAuthority.MoveInput, MoveTolerance))
+	{
+		RecordReconcileReason(EReconcileReason::MoveInput);
+		bShouldReconcile = true;
+	}
+	if (FVector::DistSquared(OrientationInput, TypedAuthority.OrientationInput) > FMath::Square(OrientationTolerance))
+	{
+		RecordReconcileReason(EReconcileReason::OrientationInput);
+		bShouldReconcile = true;
+	}
+	if (!ControlRotation.Equals(TypedAuthority.ControlRotation, AngleTolerance))
+	{
+		RecordReconcileReason(EReconcileReason::ControlRotation);
+		bShouldReconcile = true;
+	}
+	if (bJumpPressed != TypedAuthority.bJumpPressed
+		|| bJumpJustPressed != TypedAuthority.bJumpJustPressed
+		|| bCrouchPressed != TypedAuthority.bCrouchPressed)
+	{
+		RecordReconcileReason(EReconcileReason::Buttons);
+		bShouldReconcile = true;
+	}
+
+	return bShouldReconcile;
 }
 
 void FVortexInputCmd::Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct)
@@ -58,6 +339,7 @@ void FVortexInputCmd::Interpolate(const FMoverDataStructBase& From, const FMover
 	bJumpJustPressed = ClosestInputs.bJumpJustPressed;
 	bJumpPressed = ClosestInputs.bJumpPressed;
 	bCrouchPressed = ClosestInputs.bCrouchPressed;
+	MergedFrames = ClosestInputs.MergedFrames;
 
 	SetMoveInput(FMath::Lerp(FromState->GetMoveInput(), ToState->GetMoveInput(), Pct));
 	OrientationInput = FMath::Lerp(FromState->OrientationInput, ToState->OrientationInput, Pct);
@@ -66,18 +348,74 @@ void FVortexInputCmd::Interpolate(const FMoverDataStructBase& From, const FMover
 
 void FVortexInputCmd::Merge(const FMoverDataStructBase& From)
 {
+	// This is the newest frame, From the older frames folded into it
 	const FVortexInputCmd& TypedFrom = static_cast<const FVortexInputCmd&>(From);
+
+	// Time weighted, every merged sim frame counts once
+	const int32 NewerFrames = MergedFrames;
+	const int32 OlderFrames = TypedFrom.MergedFrames;
+	SetMoveInput((MoveInput * NewerFrames + TypedFrom.MoveInput * OlderFrames) / (NewerFrames + OlderFrames));
+
+	// ControlRotation and OrientationInput stay the latest. Presses anywhere in the window must survive.
 	bJumpJustPressed |= TypedFrom.bJumpJustPressed;
 	bJumpPressed |= TypedFrom.bJumpPressed;
 	bCrouchPressed |= TypedFrom.bCrouchPressed;
+
+	MergedFrames = static_cast<uint8>(FMath::Min(NewerFrames + OlderFrames, MaxMergedFrames));
 }
 
 void FVortexInputCmd::Decay(float DecayAmount)
 {
-	DecayAmount *= 0.25f; // TODO: make this configurable or a cvar
+	// One lookup for both, commands that did not come from a stream have no channel
+	FVortexInputNetChannel* Channel = NetChannelId != 0 ? VortexInputNet::FindReceiveChannel(NetChannelId) : nullptr;
 
-	MoveInput *= (1.0f - DecayAmount);
+	// The command for the frame being synthesized may have reached us as redundancy in a later packet
+	if (Channel && VortexInputNet::TryRecoverNextInput(*Channel, *this))
+	{
+		return;
+	}
 
-	// Single use inputs
-	bJumpJustPressed = FMath::IsNearlyZero(DecayAmount) ? bJumpJustPressed : false;
+	VortexInputNet::SynthesizeInput(Channel, *this, DecayAmount);
 }
+
+static void LogInputBitReport()
+{
+	// Representative held input: running diagonally, looking slightly down, jump held
+	FVortexInputCmd Sample;
+	Sample.SetMoveInput(FVector(0.71, 0.71, 0.0));
+	Sample.ControlRotation = FRotator(-12.5, 37.5, 0.0);
+	Sample.OrientationInput = Sample.ControlRotation.Vector().GetSafeNormal();
+	Sample.bJumpPressed = true;
+
+	const int64 LegacyBits = Sample.GetSerializedBitCount(EVortexInputWireFormat::Legacy);
+	const int64 CompactBits = Sample.GetSerializedBitCount(EVortexInputWireFormat::Compact);
+
+	// Compact only. Sequenced bit, stream id (packed, one byte below 128), sequence, delta bit, baseline distance, field mask,
+	// the three flags and an empty redundancy window.
+	const int32 UnchangedDeltaBits = 1 + 8 + FVortexInputNetChannel::SequenceBits + 1
+		+ FVortexInputNetChannel::BaselineDistanceBits + EVortexInputField::NumBits + 3 + FVortexInputNetChannel::RedundancyCountBits;
+
+	UE_LOG(LogVortexMover, Display, TEXT("FVortexInputCmd bits per command (rotation precision %d bits):"), VortexInputWireFormat::GetActiveRotationBits());
+	UE_LOG(LogVortexMover, Display, TEXT("  Legacy layout:   %lld"), LegacyBits);
+	UE_LOG(LogVortexMover, Display, TEXT("  Compact layout:  %lld (%.0f%% of legacy)"), CompactBits, 100.0 * CompactBits / LegacyBits);
+	UE_LOG(LogVortexMover, Display, TEXT("  Unchanged delta: %d (+1 per repeated held command)"), UnchangedDeltaBits);
+}
+
+static FAutoConsoleCommand CmdVortexInputBitReport(
+	TEXT("vortex.net.InputBitReport"),
+	TEXT("Logs how many bits a representative FVortexInputCmd takes in each wire format"),
+	FConsoleCommandDelegate::CreateStatic(&LogInputBitReport));
+
+static void LogDataStructPools()
+{
+	using FPool = TVortexDataStructPool<FVortexInputCmd>;
+	const uint64 Pooled = FPool::GetNumPoolAllocations();
+	const uint64 Heap = FPool::GetNumHeapAllocations();
+	UE_LOG(LogVortexMover, Display, TEXT("FVortexInputCmd pool (capacity %d): %llu allocations, %llu from the pool, %llu from the heap (%.2f%%)"),
+		FPool::GetCapacity(), Pooled + Heap, Pooled, Heap, Pooled + Heap > 0 ? 100.0 * Heap / (Pooled + Heap) : 0.0);
+}
+
+static FAutoConsoleCommand CmdVortexDataStructPools(
+	TEXT("vortex.debug.DataStructPools"),
+	TEXT("Logs how many Vortex data struct allocations were served from their pool and how many went to the heap"),
+	FConsoleCommandDelegate::CreateStatic(&LogDataStructPools));
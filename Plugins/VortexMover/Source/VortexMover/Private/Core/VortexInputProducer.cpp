@@ -3,80 +3,331 @@
 
 #include "Core/VortexInputProducer.h"
 
+#include "EnhancedPlayerInput.h"
+#include "GameFramework/PlayerController.h"
+#include "InputAction.h"
 #include "InputActionValue.h"
 #include "VortexMoverCVars.h"
 #include "VortexMoverLogChannels.h"
 #include "Core/VortexInputDataTypes.h"
+#include "Core/VortexMoverComponent.h"
+
+namespace
+{
+	// Only autonomous proxies upload their input, the server's own commands never go on a stream
+	uint32 GetUploadStreamId(const APawn* Pawn)
+	{
+		const UVortexMoverComponent* Mover = Pawn && Pawn->GetLocalRole() == ROLE_AutonomousProxy ? Pawn->FindComponentByClass<UVortexMoverComponent>() : nullptr;
+		return Mover ? Mover->GetInputStreamId() : 0;
+	}
+}
 
 void UVortexInputProducer::Initialize(APawn* InOwnerPawn)
 {
 	ensure(InOwnerPawn);
 	OwnerPawn = InOwnerPawn;
+	DeferredEvents.Reserve(64);
 	ResetCachedInput();
 }
 
 void UVortexInputProducer::ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult)
 {
 	FVortexInputCmd& Cmd = InputCmdResult.InputCollection.FindOrAddMutableDataByType<FVortexInputCmd>();
+
+	// Map this tick's sim window [PrevSimTimeMs, SimTimeMs] onto real time, starting where the last window ended.
+	// Never ahead of now, and resynced after hitches, (re)starts or sim time going backwards.
+	const double Now = FPlatformTime::Seconds();
+	const int32 SimDeltaMs = SimTimeMs - PrevSimTimeMs;
+	double WindowEnd = WindowStart + SimDeltaMs / 1000.0;
+	if (!bHasWindow || SimDeltaMs < 0 || WindowEnd > Now || Now - WindowEnd > VortexMoverCVars::GetInputWindowMaxLag())
+	{
+		WindowEnd = Now;
+	}
+	if (!bHasWindow)
+	{
+		WindowStart = Now;
+		bHasWindow = true;
+	}
+	PrevSimTimeMs = SimTimeMs;
+
+	IntegrateInputWindow(WindowEnd, VortexMoverCVars::IsInputSubTickAccumulationEnabled());
+
+	// The pawn may only be read on the game thread, elsewhere use the last published snapshot
+	if (!IsInGameThread())
+	{
+		if (OwnerStateBuffer.IsDirty())
+		{
+			const FVortexInputOwnerState& OwnerState = OwnerStateBuffer.SwapAndRead();
+			OwnerControlRotation = OwnerState.ControlRotation;
+			bOwnerLocallyControlled = OwnerState.bLocallyControlled;
+			OwnerInputStreamId = OwnerState.InputStreamId;
+		}
+	}
+	else
+	{
+		const APawn* Pawn = OwnerPawn.Get();
+		bOwnerLocallyControlled = Pawn && Pawn->IsLocallyControlled();
+		OwnerControlRotation = Pawn ? Pawn->GetControlRotation() : FRotator::ZeroRotator;
+
+		const APlayerController* PC = Pawn && SamplingMode == EVortexInputSamplingMode::Polled ? Cast<APlayerController>(Pawn->GetController()) : nullptr;
+		if (const UEnhancedPlayerInput* PlayerInput = PC ? Cast<UEnhancedPlayerInput>(PC->PlayerInput) : nullptr)
+		{
+			SamplePolledInput(*PlayerInput);
+		}
+	}
 	
+	if (ProduceReplayedInput(SimTimeMs, Cmd))
+	{
+		StampInputFrame(Cmd);
+		return;
+	}
+
 	// Only produce for locally-controlled pawns with a controller (client-side).
-	if (!OwnerPawn.IsValid() || !OwnerPawn->IsLocallyControlled())
+	if (!bOwnerLocallyControlled)
 	{
 		static const FVortexInputCmd EmptyInput;
 		Cmd = EmptyInput;
 		return;
 	}
 	
-	Cmd.ControlRotation = OwnerPawn->GetControlRotation();
+	// Look input reaches the command through the control rotation. Also derives OrientationInput (facing intent).
+	Cmd.SetControlRotation(OwnerControlRotation);
 
-	const FVector FinalDirectionalIntent = Cmd.ControlRotation.RotateVector(CachedMove);
+	const FVector FinalDirectionalIntent = Cmd.ControlRotation.RotateVector(WindowMove);
 	Cmd.SetMoveInput(FinalDirectionalIntent);
-
-	// TODO: this is facing intent, not input, and the LookInput cached value is actually not being used here in this class at all, could remove later
-	Cmd.OrientationInput = Cmd.ControlRotation.Vector().GetSafeNormal();
 	
-	Cmd.bJumpPressed = bJumpPressed;
+	Cmd.bJumpPressed = bWindowJumpHeld;
 	Cmd.bJumpJustPressed = bJumpJustPressed;
-	Cmd.bCrouchPressed = bCrouchPressed;
+	Cmd.bCrouchPressed = bWindowCrouchHeld;
+	StampInputFrame(Cmd);
 
 	
 	const int32 DebugLevel = VortexMoverCVars::IsInputDebugEnabled();
 	if (DebugLevel >= 2) {LogOnChange(); }
-	else if (DebugLevel >= 1) { LogPerFrame(); }
+	else if (DebugLevel >= 1) { LogPerFrame(Cmd); }
 
 	// Clear single-use inputs
 	bJumpJustPressed = false;
 }
 
+void UVortexInputProducer::StampInputFrame(FVortexInputCmd& Cmd)
+{
+	// Off the game thread the id comes with the owner snapshot
+	if (IsInGameThread())
+	{
+		OwnerInputStreamId = GetUploadStreamId(OwnerPawn.Get());
+	}
+	Cmd.NetSequence = NextInputFrame++;
+	Cmd.NetStreamId = OwnerInputStreamId;
+}
+
 void UVortexInputProducer::OnMove(const FInputActionValue& Value)
 {
 	const FVector MovementVector = Value.Get<FVector>();
-	CachedMove.X = FMath::Clamp(MovementVector.X, -1.0f, 1.0f);
-	CachedMove.Y = FMath::Clamp(MovementVector.Y, -1.0f, 1.0f);
-	CachedMove.Z = FMath::Clamp(MovementVector.Z, -1.0f, 1.0f);
+	FVortexInputEvent Event;
+	Event.Type = FVortexInputEvent::EType::Move;
+	Event.Value.X = FMath::Clamp(MovementVector.X, -1.0f, 1.0f);
+	Event.Value.Y = FMath::Clamp(MovementVector.Y, -1.0f, 1.0f);
+	Event.Value.Z = FMath::Clamp(MovementVector.Z, -1.0f, 1.0f);
+	EnqueueEvent(Event);
 }
 
 void UVortexInputProducer::OnLook(const FInputActionValue& Value)
 {
 	const FVector2D LookVector = Value.Get<FVector2D>();
-	CachedLook.Yaw = FMath::Clamp(LookVector.X, -1.0f, 1.0f);
-	CachedLook.Pitch = FMath::Clamp(LookVector.Y, -1.0f, 1.0f);
+	FVortexInputEvent Event;
+	Event.Type = FVortexInputEvent::EType::Look;
+	Event.Value.X = FMath::Clamp(LookVector.X, -1.0f, 1.0f);
+	Event.Value.Y = FMath::Clamp(LookVector.Y, -1.0f, 1.0f);
+	EnqueueEvent(Event);
 }
 
 void UVortexInputProducer::OnJump(const FInputActionValue& Value)
 {
-	const bool bNewPressed = Value.Get<bool>();
-	bJumpJustPressed = bNewPressed && !bJumpPressed;
-	bJumpPressed = bNewPressed;
+	FVortexInputEvent Event;
+	Event.Type = FVortexInputEvent::EType::Jump;
+	Event.bPressed = Value.Get<bool>();
+	EnqueueEvent(Event);
 }
 
 void UVortexInputProducer::OnCrouch(const FInputActionValue& Value)
 {
-	bCrouchPressed = Value.Get<bool>();
+	FVortexInputEvent Event;
+	Event.Type = FVortexInputEvent::EType::Crouch;
+	Event.bPressed = Value.Get<bool>();
+	EnqueueEvent(Event);
+}
+
+void UVortexInputProducer::PublishOwnerState()
+{
+	const APawn* Pawn = OwnerPawn.Get();
+	const bool bLocallyControlled = Pawn && Pawn->IsLocallyControlled();
+	if (!bLocallyControlled && !bPublishedLocallyControlled)
+	{
+		return;
+	}
+	bPublishedLocallyControlled = bLocallyControlled;
+
+	FVortexInputOwnerState OwnerState;
+	OwnerState.bLocallyControlled = bLocallyControlled;
+	OwnerState.ControlRotation = Pawn ? Pawn->GetControlRotation() : FRotator::ZeroRotator;
+	OwnerState.InputStreamId = GetUploadStreamId(Pawn);
+	OwnerStateBuffer.WriteAndSwap(OwnerState);
+}
+
+bool UVortexInputProducer::ProduceReplayedInput(int32 SimTimeMs, FVortexInputCmd& Cmd)
+{
+	return VortexInputCapture::Replay(ReplayCursor, OwnerPawn.Get(), SimTimeMs, Cmd);
+}
+
+void UVortexInputProducer::SetPolledInputActions(const UInputAction* InMoveAction, const UInputAction* InLookAction, const UInputAction* InJumpAction, const UInputAction* InCrouchAction)
+{
+	PolledMoveAction = InMoveAction;
+	PolledLookAction = InLookAction;
+	PolledJumpAction = InJumpAction;
+	PolledCrouchAction = InCrouchAction;
+}
+
+void UVortexInputProducer::SamplePolledInput(const UEnhancedPlayerInput& PlayerInput)
+{
+	// Same clamping and edge handling as the event path, the sampled values hold for the whole window. Buttons are only
+	// ever added: a tap that already ended was latched from its events and must not be sampled away.
+	FVortexInputEvent Event;
+	Event.Time = FPlatformTime::Seconds();
+
+	if (PolledMoveAction)
+	{
+		const FVector MovementVector = PlayerInput.GetActionValue(PolledMoveAction).Get<FVector>();
+		Event.Type = FVortexInputEvent::EType::Move;
+		Event.Value = FVector(FMath::Clamp(MovementVector.X, -1.0f, 1.0f), FMath::Clamp(MovementVector.Y, -1.0f, 1.0f), FMath::Clamp(MovementVector.Z, -1.0f, 1.0f));
+		ApplyEvent(Event);
+		WindowMove = CachedMove;
+	}
+	if (PolledLookAction)
+	{
+		const FVector2D LookVector = PlayerInput.GetActionValue(PolledLookAction).Get<FVector2D>();
+		CachedLook.Yaw = FMath::Clamp(LookVector.X, -1.0f, 1.0f);
+		CachedLook.Pitch = FMath::Clamp(LookVector.Y, -1.0f, 1.0f);
+	}
+	if (PolledJumpAction)
+	{
+		Event.Type = FVortexInputEvent::EType::Jump;
+		Event.bPressed = PlayerInput.GetActionValue(PolledJumpAction).Get<bool>();
+		ApplyEvent(Event);
+		bWindowJumpHeld |= bJumpPressed;
+	}
+	if (PolledCrouchAction)
+	{
+		Event.Type = FVortexInputEvent::EType::Crouch;
+		Event.bPressed = PlayerInput.GetActionValue(PolledCrouchAction).Get<bool>();
+		ApplyEvent(Event);
+		bWindowCrouchHeld |= bCrouchPressed;
+	}
+}
+
+void UVortexInputProducer::EnqueueEvent(FVortexInputEvent& Event)
+{
+	Event.Time = FPlatformTime::Seconds();
+	PendingEvents.Enqueue(Event);
+}
+
+void UVortexInputProducer::DiscardPendingEvents()
+{
+	FVortexInputEvent Event;
+	while (PendingEvents.Dequeue(Event))
+	{
+	}
+	DeferredEvents.Reset();
+}
+
+void UVortexInputProducer::IntegrateInputWindow(double WindowEnd, bool bTimeWeighted)
+{
+	FVortexInputEvent Event;
+	while (PendingEvents.Dequeue(Event))
+	{
+		DeferredEvents.Add(Event);
+	}
+
+	// Without time weighting every event counts, the tick sees only the latest values
+	const double IntegrationEnd = bTimeWeighted ? WindowEnd : TNumericLimits<double>::Max();
+
+	FVector MoveIntegral = FVector::ZeroVector;
+	double Cursor = WindowStart;
+	bWindowJumpHeld = bJumpPressed;
+	bWindowCrouchHeld = bCrouchPressed;
+
+	int32 NumApplied = 0;
+	for (; NumApplied < DeferredEvents.Num(); ++NumApplied)
+	{
+		const FVortexInputEvent& Deferred = DeferredEvents[NumApplied];
+		if (Deferred.Time > IntegrationEnd)
+		{
+			break;
+		}
+
+		// Move is piecewise constant between events
+		const double EventTime = FMath::Clamp(Deferred.Time, Cursor, WindowEnd);
+		MoveIntegral += CachedMove * (EventTime - Cursor);
+		Cursor = EventTime;
+
+		ApplyEvent(Deferred);
+
+		// A tap that starts and ends inside the window still shows up as held for this tick
+		bWindowJumpHeld |= bJumpPressed;
+		bWindowCrouchHeld |= bCrouchPressed;
+	}
+	DeferredEvents.RemoveAt(0, NumApplied, EAllowShrinking::No);
+
+	MoveIntegral += CachedMove * (WindowEnd - Cursor);
+	const double WindowLength = WindowEnd - WindowStart;
+	WindowMove = bTimeWeighted && WindowLength > UE_SMALL_NUMBER ? MoveIntegral / WindowLength : CachedMove;
+	if (!bTimeWeighted)
+	{
+		bWindowJumpHeld = bJumpPressed;
+		bWindowCrouchHeld = bCrouchPressed;
+	}
+
+	WindowStart = WindowEnd;
+}
+
+void UVortexInputProducer::ApplyEvent(const FVortexInputEvent& Event)
+{
+	switch (Event.Type)
+	{
+	case FVortexInputEvent::EType::Move:
+		CachedMove = Event.Value;
+		break;
+	case FVortexInputEvent::EType::Look:
+		// Debug only, the controller applies look to its control rotation, which is what the command carries
+		CachedLook.Yaw = Event.Value.X;
+		CachedLook.Pitch = Event.Value.Y;
+		break;
+	case FVortexInputEvent::EType::Jump:
+		// Sticky until a command carried it, so a press and release between two ticks is still seen once
+		bJumpJustPressed |= Event.bPressed && !bJumpPressed;
+		bJumpPressed = Event.bPressed;
+		break;
+	case FVortexInputEvent::EType::Crouch:
+		bCrouchPressed = Event.bPressed;
+		break;
+	case FVortexInputEvent::EType::Reset:
+		ResetConsumerState();
+		break;
+	}
 }
 
 void UVortexInputProducer::ResetCachedInput()
 {
+	FVortexInputEvent Event;
+	Event.Type = FVortexInputEvent::EType::Reset;
+	EnqueueEvent(Event);
+}
+
+void UVortexInputProducer::ResetConsumerState()
+{
+	WindowMove = FVector::ZeroVector;
+	bWindowJumpHeld = false;
+	bWindowCrouchHeld = false;
 	CachedMove = FVector::ZeroVector;
 	CachedLook = FRotator::ZeroRotator;
 	bJumpPressed = false;
@@ -89,14 +340,16 @@ void UVortexInputProducer::ResetCachedInput()
 	bPrevCrouchPressed = false;
 }
 
-void UVortexInputProducer::LogPerFrame() const
+void UVortexInputProducer::LogPerFrame(const FVortexInputCmd& Cmd) const
 {
-	UE_LOG(LogVortexMoverInput, Log, TEXT("[Produce] Move(%.2f,%.2f) Look(%.2f,%.2f) Jump(P:%d JP:%d) Crouch(P:%d)"),
+	UE_LOG(LogVortexMoverInput, Log, TEXT("[Produce] Move(%.2f,%.2f) Look(%.2f,%.2f) Jump(P:%d JP:%d) Crouch(P:%d) Bits(Legacy:%lld Compact:%lld)"),
 	CachedMove.X, CachedMove.Y,
 	CachedLook.Pitch, CachedLook.Yaw,
 	bJumpPressed ? 1 : 0,
 	bJumpJustPressed ? 1 : 0,
-	bCrouchPressed ? 1 : 0);
+	bCrouchPressed ? 1 : 0,
+	Cmd.GetSerializedBitCount(EVortexInputWireFormat::Legacy),
+	Cmd.GetSerializedBitCount(EVortexInputWireFormat::Compact));
 }
 
 void UVortexInputProducer::LogOnChange()
@@ -3,11 +3,386 @@
 
 #include "Core/VortexMoverComponent.h"
 
-#include "Modes/SimpleWalking.h"
+#include "Core/VortexMoverSubsystem.h"
+#include "Modes/VortexWalkingMode.h"
+#include "Net/UnrealNetwork.h"
+#include "Net/VortexInputNetChannel.h"
+#include "Net/VortexProxyState.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverLogChannels.h"
+
+namespace
+{
+	const FName WalkingModeName = "Vortex_Walking";
+	// Mode every component used to create, still serialized by Blueprints saved before it was removed
+	const FName LegacyWalkingModeName = "Simple_Walking";
+}
 
 UVortexMoverComponent::UVortexMoverComponent()
 {
-	MovementModes.Add("Simple_Walking", CreateDefaultSubobject<USimpleWalking>(TEXT("SimpleWalkingMode")));
+	// Mover looks modes up through the owning component, so every pawn still creates its own mode object.
+	// Keep it thin: tuning comes from a shared UVortexWalkingSettings asset.
+	MovementModes.Add(WalkingModeName, CreateDefaultSubobject<UVortexWalkingMode>(TEXT("VortexWalkingMode")));
+
+	StartingMovementMode = WalkingModeName;
+
+	// Needed for the input stream acknowledgements
+	SetIsReplicatedByDefault(true);
+}
+
+void UVortexMoverComponent::PostLoad()
+{
+	Super::PostLoad();
+
+	// Redirect for Blueprints saved with the old mode: drop it before it is instanced for every pawn. Resaving removes it for good.
+	if (MovementModes.Remove(LegacyWalkingModeName) > 0)
+	{
+		UE_LOG(LogVortexMover, Log, TEXT("%s: removed the legacy %s movement mode, resave the asset"), *GetPathName(), *LegacyWalkingModeName.ToString());
+	}
+	if (StartingMovementMode == LegacyWalkingModeName)
+	{
+		StartingMovementMode = WalkingModeName;
+	}
+}
+
+void UVortexMoverComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Snapshots.Init(VortexMoverCVars::GetSnapshotFrames());
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		History.Init(VortexMoverCVars::GetLagCompHistoryFrames());
+		InputStreamId = VortexInputNet::AddReceiveStream();
+	}
+
+	if (const USceneComponent* Visual = GetPrimaryVisualComponent())
+	{
+		VisualRelativeTransform = Visual->GetRelativeTransform();
+	}
+	ConfiguredSmoothingMode = SmoothingMode;
+	// The jitter buffer replaces Mover's smoothing, the visual must not be offset twice
+	if (UsesProxyJitterBuffer())
+	{
+		SmoothingMode = EMoverSmoothingMode::None;
+	}
+
+	// Per frame Vortex work is batched across all movers by the subsystem
+	if (UVortexMoverSubsystem* Subsystem = UWorld::GetSubsystem<UVortexMoverSubsystem>(GetWorld()))
+	{
+		Subsystem->RegisterMover(this);
+	}
+
+	OnPreSimulationTick.AddDynamic(this, &UVortexMoverComponent::HandlePreSimulationTick);
+	OnPostSimulationTick.AddDynamic(this, &UVortexMoverComponent::HandlePostSimulationTick);
+}
+
+void UVortexMoverComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UVortexMoverSubsystem* Subsystem = UWorld::GetSubsystem<UVortexMoverSubsystem>(GetWorld()))
+	{
+		Subsystem->UnregisterMover(this);
+	}
+
+	if (InputStreamId != 0)
+	{
+		if (GetOwnerRole() == ROLE_Authority)
+		{
+			VortexInputNet::RemoveReceiveStream(InputStreamId);
+		}
+		else
+		{
+			VortexInputNet::RemoveSendStream(InputStreamId);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UVortexMoverComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Only the owning client uploads input
+	DOREPLIFETIME_CONDITION(UVortexMoverComponent, InputStreamId, COND_OwnerOnly);
+	// The owner predicts its own pawn, only simulated proxies play the authority transform back
+	DOREPLIFETIME_CONDITION(UVortexMoverComponent, ProxyState, COND_SimulatedOnly);
+}
+
+void UVortexMoverComponent::SetCrowdVelocity(const FVector& InCrowdVelocity)
+{
+	// Nothing to hand over while the mover stays unpushed
+	if (InCrowdVelocity.IsZero() && !bCrowdVelocitySet)
+	{
+		return;
+	}
+	bCrowdVelocitySet = !InCrowdVelocity.IsZero();
+	CrowdVelocityBuffer.WriteAndSwap(InCrowdVelocity);
+}
+
+const FVector& UVortexMoverComponent::ConsumeCrowdVelocity()
+{
+	if (CrowdVelocityBuffer.IsDirty())
+	{
+		SimCrowdVelocity = CrowdVelocityBuffer.SwapAndRead();
+	}
+	return SimCrowdVelocity;
+}
+
+void UVortexMoverComponent::UpdateNetUpdateFrequency(const FVector& Velocity, uint16 QuietFrames, float DeltaTime)
+{
+	AActor* Owner = GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	// A sleeping pawn's state does not change, the heartbeat is all it needs to send whether or not the adaptive rate is on
+	const bool bAsleep = IsSimAsleep();
+	const bool bNetRateEnabled = VortexMoverCVars::IsNetRateEnabled();
+	if (!bNetRateEnabled && !bAsleep)
+	{
+		if (bNetRateActive)
+		{
+			Owner->SetNetUpdateFrequency(ConfiguredNetUpdateFrequency);
+			bNetRateActive = false;
+			// Woke up: the new state goes out now rather than after the rest of a heartbeat interval
+			if (bNetIdle)
+			{
+				Owner->ForceNetUpdate();
+			}
+			bNetIdle = false;
+		}
+		return;
+	}
+
+	if (!bNetRateActive)
+	{
+		ConfiguredNetUpdateFrequency = Owner->GetNetUpdateFrequency();
+		bNetRateActive = true;
+	}
+	if (DeltaTime <= 0.0f)
+	{
+		return;
+	}
+
+	// Quiet movers have no velocity left, so they are standing on something rather than falling
+	const bool bWasIdle = bNetIdle;
+	bNetIdle = bAsleep || QuietFrames >= VortexMoverCVars::GetNetRateIdleFrames();
+
+	// Only asleep gets here with the adaptive rate off
+	float Frequency = FMath::Min(VortexMoverCVars::GetNetRateIdleFrequency(), ConfiguredNetUpdateFrequency);
+	if (bNetRateEnabled)
+	{
+		const float FullRateAcceleration = FMath::Max(VortexMoverCVars::GetNetRateFullRateAcceleration(), 1.0f);
+		const float Change = FMath::Min(static_cast<float>((Velocity - NetRateVelocity).Size()) / (DeltaTime * FullRateAcceleration), 1.0f);
+		NetRateVelocity = Velocity;
+		// Rises at once, decays over a few frames so a single steady frame does not drop the rate
+		NetRateChange = FMath::Max(Change, FMath::Lerp(NetRateChange, Change, FMath::Min(DeltaTime * 4.0f, 1.0f)));
+
+		if (!bNetIdle)
+		{
+			Frequency = FMath::Min(FMath::Lerp(VortexMoverCVars::GetNetRateMinFrequency(), VortexMoverCVars::GetNetRateMaxFrequency(), NetRateChange), ConfiguredNetUpdateFrequency);
+		}
+	}
+	if (!FMath::IsNearlyEqual(Owner->GetNetUpdateFrequency(), Frequency, 0.5f))
+	{
+		Owner->SetNetUpdateFrequency(Frequency);
+	}
+
+	// Waking up should not wait out the rest of a heartbeat interval
+	if (bWasIdle && !bNetIdle)
+	{
+		Owner->ForceNetUpdate();
+	}
+}
+
+float UVortexMoverComponent::GetNetPriorityScale(const FVector& ViewPos, const FVector& ViewDir) const
+{
+	const USceneComponent* UpdatedComponent = GetUpdatedComponent();
+	if (!UpdatedComponent || !VortexMoverCVars::IsNetRateEnabled())
+	{
+		return 1.0f;
+	}
+
+	float Scale = bNetIdle ? VortexMoverCVars::GetNetPriorityIdleScale() : 1.0f;
+
+	const FVector ToMover = UpdatedComponent->GetComponentLocation() - ViewPos;
+	const double Distance = ToMover.Size();
+	const double PriorityDistance = VortexMoverCVars::GetNetPriorityDistance();
+	if (Distance > PriorityDistance)
+	{
+		Scale *= static_cast<float>(PriorityDistance / Distance);
+	}
+	if (Distance > UE_KINDA_SMALL_NUMBER && FVector::DotProduct(ToMover, ViewDir) < 0.0)
+	{
+		Scale *= VortexMoverCVars::GetNetPriorityOutOfViewScale();
+	}
+	return Scale;
+}
+
+void UVortexMoverComponent::SetProxyLOD(EVortexMoverLOD InLOD)
+{
+	if (InLOD == ProxyLOD)
+	{
+		return;
+	}
+
+	// The buffered timeline is stale after a stretch of snapping, what was measured about the connection is not
+	if (ProxyLOD == EVortexMoverLOD::Snap)
+	{
+		ProxyJitterBuffer.ResetTimeline();
+	}
+	ProxyLOD = InLOD;
+	ProxyLODAccumulatedTime = 0.0f;
+
+	// Mover's own smoothing cannot be throttled, only switched off while snapping
+	if (ProxySmoothingMode == EVortexProxySmoothingMode::Mover)
+	{
+		SmoothingMode = InLOD == EVortexMoverLOD::Snap ? EMoverSmoothingMode::None : ConfiguredSmoothingMode;
+		if (USceneComponent* Visual = GetPrimaryVisualComponent(); Visual && InLOD == EVortexMoverLOD::Snap)
+		{
+			Visual->SetRelativeTransform(VisualRelativeTransform);
+		}
+	}
+}
+
+void UVortexMoverComponent::UpdateProxySmoothing(float DeltaTime)
+{
+	USceneComponent* Visual = GetPrimaryVisualComponent();
+	if (!UsesProxyJitterBuffer() || ProxyLOD == EVortexMoverLOD::Snap || !Visual)
+	{
+		return;
+	}
+
+	// Samples keep arriving at full rate, only playback is throttled
+	if (ProxyLOD == EVortexMoverLOD::Reduced)
+	{
+		ProxyLODAccumulatedTime += DeltaTime;
+		if (ProxyLODAccumulatedTime * VortexMoverCVars::GetLODReducedRate() < 1.0f)
+		{
+			return;
+		}
+		DeltaTime = ProxyLODAccumulatedTime;
+		ProxyLODAccumulatedTime = 0.0f;
+	}
+
+	// Same clock as FVortexProxyState::ArrivalTime
+	FTransform Shown;
+	if (ProxyJitterBuffer.Evaluate(FPlatformTime::Seconds(), DeltaTime, Shown))
+	{
+		Visual->SetWorldTransform(VisualRelativeTransform * Shown);
+	}
+}
+
+void UVortexMoverComponent::UpdateProxyState()
+{
+	const USceneComponent* UpdatedComponent = GetUpdatedComponent();
+	if (!UsesProxyJitterBuffer() || !UpdatedComponent)
+	{
+		return;
+	}
+
+	// Below what the wire keeps the state counts as unchanged, so an idle or sleeping pawn sends nothing
+	const FVector Location = UpdatedComponent->GetComponentLocation();
+	const FRotator Orientation = UpdatedComponent->GetComponentRotation();
+	if (ProxyState.ServerFrame != INDEX_NONE && Location.Equals(ProxyState.Location, 0.01) && Orientation.Equals(ProxyState.Orientation, 0.005))
+	{
+		return;
+	}
+
+	ProxyState.ServerFrame = LastSimFrame.load(std::memory_order_relaxed);
+	ProxyState.Location = Location;
+	ProxyState.Orientation = Orientation;
+}
+
+void UVortexMoverComponent::SendInputAck()
+{
+	FVortexInputNetChannel* Channel = VortexInputNet::FindReceiveChannel(InputStreamId);
+	if (!Channel || !Channel->bAckPending)
+	{
+		return;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now - Channel->LastAckSendTime < VortexMoverCVars::GetInputAckInterval())
+	{
+		return;
+	}
+
+	ClientAckInputSequence(Channel->LastReceivedSequence);
+	Channel->bAckPending = false;
+	Channel->LastAckSendTime = Now;
+}
+
+void UVortexMoverComponent::ClientAckInputSequence_Implementation(uint8 Sequence)
+{
+	if (FVortexInputNetChannel* Channel = VortexInputNet::FindSendChannel(InputStreamId))
+	{
+		Channel->OnAckReceived(Sequence);
+	}
+}
+
+void UVortexMoverComponent::ConsumeSimulationCost(uint64& OutCycles, uint32& OutTicks)
+{
+	OutCycles = SimulationCycles.exchange(0, std::memory_order_relaxed);
+	OutTicks = SimulationTicks.exchange(0, std::memory_order_relaxed);
+}
+
+void UVortexMoverComponent::HandlePreSimulationTick(const FMoverTimeStep& TimeStep, const FMoverInputCmdContext& InputCmd)
+{
+	// The input this pawn actually simulates with, resimulations replay frames that were already recorded
+	if (!TimeStep.bIsResimulating)
+	{
+		if (const FVortexInputCmd* Cmd = InputCmd.InputCollection.FindDataByType<FVortexInputCmd>())
+		{
+			VortexInputCapture::Record(InputRecordCursor, GetOwner(), FMath::RoundToInt32(TimeStep.BaseSimTimeMs), *Cmd);
+		}
+	}
+
+	SimTickStartCycles = FPlatformTime::Cycles64();
+}
+
+void UVortexMoverComponent::HandlePostSimulationTick(const FMoverTimeStep& TimeStep)
+{
+	// Keyed by the sim time the frame ended at, so a rewind lines up with the frames clients simulated
+	const USceneComponent* UpdatedComponent = GetUpdatedComponent();
+	if (!TimeStep.bIsResimulating && UpdatedComponent && History.IsEnabled())
+	{
+		const double EndTime = (TimeStep.BaseSimTimeMs + TimeStep.StepMs) / 1000.0;
+		History.Record(EndTime, UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentQuat(), GetVelocity());
+	}
+
+	if (!TimeStep.bIsResimulating)
+	{
+		bSimAsleep.store(bSleepingTick, std::memory_order_relaxed);
+		LastSimFrame.store(TimeStep.ServerFrame, std::memory_order_relaxed);
+	}
+	bSleepingTick = false;
+
+	SimulationCycles.fetch_add(FPlatformTime::Cycles64() - SimTickStartCycles, std::memory_order_relaxed);
+	SimulationTicks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UVortexMoverComponent::OnRep_ProxyState()
+{
+	if (!UsesProxyJitterBuffer())
+	{
+		return;
+	}
+
+	ProxyState.ArrivalTime = FPlatformTime::Seconds();
+
+	const FTransform Received(ProxyState.Orientation, ProxyState.Location);
+	if (ProxyLOD == EVortexMoverLOD::Snap)
+	{
+		if (USceneComponent* Visual = GetPrimaryVisualComponent())
+		{
+			Visual->SetWorldTransform(VisualRelativeTransform * Received);
+		}
+		return;
+	}
 
-	StartingMovementMode = "Simple_Walking";
+	ProxyJitterBuffer.AddSample(ProxyState.ArrivalTime, Received);
 }
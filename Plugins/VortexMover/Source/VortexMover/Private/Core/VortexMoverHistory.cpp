@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/VortexMoverHistory.h"
+
+#include "Misc/ScopeLock.h"
+
+void FVortexMoverHistory::Init(int32 InCapacity)
+{
+	FScopeLock ScopeLock(&Lock);
+	Entries.Reset();
+	Entries.SetNum(FMath::Max(InCapacity, 0));
+	First = 0;
+	Num = 0;
+}
+
+void FVortexMoverHistory::Record(double Time, const FVector& Location, const FQuat& Rotation, const FVector& Velocity)
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Entries.IsEmpty() || (Num > 0 && Time < Get(Num - 1).Time))
+	{
+		return;
+	}
+
+	int32 Slot;
+	if (Num > 0 && Time == Get(Num - 1).Time)
+	{
+		Slot = (First + Num - 1) % Entries.Num();
+	}
+	else if (Num < Entries.Num())
+	{
+		Slot = (First + Num) % Entries.Num();
+		++Num;
+	}
+	else
+	{
+		// Full, the oldest entry makes room
+		Slot = First;
+		First = (First + 1) % Entries.Num();
+	}
+
+	FEntry& Entry = Entries[Slot];
+	Entry.Time = Time;
+	Entry.Location = FVector3f(Location);
+	Entry.Velocity = FVector3f(Velocity);
+	Entry.Rotation = FQuat4f(Rotation);
+}
+
+bool FVortexMoverHistory::Evaluate(double Time, FVector& OutLocation, FQuat& OutRotation, FVector& OutVelocity) const
+{
+	FScopeLock ScopeLock(&Lock);
+	if (Num == 0)
+	{
+		return false;
+	}
+
+	// First entry newer than Time
+	int32 Low = 0;
+	int32 High = Num;
+	while (Low < High)
+	{
+		const int32 Mid = (Low + High) / 2;
+		if (Get(Mid).Time <= Time)
+		{
+			Low = Mid + 1;
+		}
+		else
+		{
+			High = Mid;
+		}
+	}
+
+	if (Low == 0 || Low == Num)
+	{
+		const FEntry& Edge = Get(Low == 0 ? 0 : Num - 1);
+		OutLocation = FVector(Edge.Location);
+		OutRotation = FQuat(Edge.Rotation);
+		OutVelocity = FVector(Edge.Velocity);
+		return true;
+	}
+
+	const FEntry& From = Get(Low - 1);
+	const FEntry& To = Get(Low);
+	const float Alpha = static_cast<float>((Time - From.Time) / (To.Time - From.Time));
+	OutLocation = FVector(FMath::Lerp(From.Location, To.Location, Alpha));
+	OutRotation = FQuat(FQuat4f::Slerp(From.Rotation, To.Rotation, Alpha));
+	OutVelocity = FVector(FMath::Lerp(From.Velocity, To.Velocity, Alpha));
+	return true;
+}
+
+double FVortexMoverHistory::GetOldestTime() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Num > 0 ? Get(0).Time : 0.0;
+}
+
+double FVortexMoverHistory::GetNewestTime() const
+{
+	FScopeLock ScopeLock(&Lock);
+	return Num > 0 ? Get(Num - 1).Time : 0.0;
+}
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/VortexMoverSpatialHash.h"
+
+bool FVortexMoverSpatialHash::SetCellSize(float InCellSize)
+{
+	InCellSize = FMath::Max(InCellSize, 1.0f);
+	if (InCellSize == CellSize)
+	{
+		return false;
+	}
+
+	CellSize = InCellSize;
+	Reset();
+	return true;
+}
+
+uint64 FVortexMoverSpatialHash::GetCellKey(const FVector& Location) const
+{
+	return MakeKey(FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize));
+}
+
+void FVortexMoverSpatialHash::Add(int32 Index, uint64 CellKey)
+{
+	Cells.FindOrAdd(CellKey).Add(Index);
+}
+
+void FVortexMoverSpatialHash::Remove(int32 Index, uint64 CellKey)
+{
+	// Empty buckets stay allocated, crowds keep revisiting the same cells
+	if (TArray<int32>* Bucket = Cells.Find(CellKey))
+	{
+		Bucket->RemoveSingleSwap(Index, EAllowShrinking::No);
+	}
+}
+
+void FVortexMoverSpatialHash::Move(int32 Index, uint64 OldCellKey, uint64 NewCellKey)
+{
+	if (OldCellKey != NewCellKey)
+	{
+		Remove(Index, OldCellKey);
+		Add(Index, NewCellKey);
+	}
+}
+
+void FVortexMoverSpatialHash::Reindex(int32 OldIndex, int32 NewIndex, uint64 CellKey)
+{
+	if (TArray<int32>* Bucket = Cells.Find(CellKey))
+	{
+		if (int32* Slot = Bucket->FindByKey(OldIndex))
+		{
+			*Slot = NewIndex;
+		}
+	}
+}
+
+void FVortexMoverSpatialHash::Reset()
+{
+	Cells.Reset();
+}
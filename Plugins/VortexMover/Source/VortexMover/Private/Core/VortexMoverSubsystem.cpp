@@ -0,0 +1,443 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/VortexMoverSubsystem.h"
+
+#include "Async/ParallelFor.h"
+#include "Components/CapsuleComponent.h"
+#include "Core/VortexInputProducer.h"
+#include "Core/VortexMoverComponent.h"
+#include "GameFramework/PlayerController.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverStats.h"
+
+DECLARE_CYCLE_STAT(TEXT("Subsystem Gather"), STAT_VortexSubsystemGather, STATGROUP_VortexMover);
+DECLARE_CYCLE_STAT(TEXT("Subsystem Crowd"), STAT_VortexSubsystemCrowd, STATGROUP_VortexMover);
+DECLARE_CYCLE_STAT(TEXT("Subsystem Write Back"), STAT_VortexSubsystemWriteBack, STATGROUP_VortexMover);
+DECLARE_CYCLE_STAT(TEXT("Subsystem Rewind Query"), STAT_VortexSubsystemRewind, STATGROUP_VortexMover);
+DECLARE_CYCLE_STAT(TEXT("Subsystem Proxy LOD"), STAT_VortexSubsystemLOD, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Movers"), STAT_VortexMovers, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxies: Full LOD"), STAT_VortexProxiesFull, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxies: Reduced LOD"), STAT_VortexProxiesReduced, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Proxies: Snap LOD"), STAT_VortexProxiesSnap, STATGROUP_VortexMover);
+
+namespace
+{
+	// Below this per frame displacement (cm) and speed (cm/s) a mover counts as quiet
+	constexpr double QuietDistanceSq = 0.01 * 0.01;
+	constexpr double QuietSpeedSq = 1.0;
+}
+
+int32 FVortexMoverHotState::Add()
+{
+	Locations.Add(FVector::ZeroVector);
+	Velocities.Add(FVector::ZeroVector);
+	QuietFrames.Add(0);
+	RemoteRoles.Add(ROLE_None);
+	Radii.Add(0.0f);
+	HalfHeights.Add(0.0f);
+	CellKeys.Add(0);
+	CrowdVelocities.Add(FVector::ZeroVector);
+	Significances.Add(0.0f);
+	LODs.Add(static_cast<uint8>(EVortexMoverLOD::Full));
+	return Roles.Add(ROLE_None);
+}
+
+void FVortexMoverHotState::RemoveAtSwap(int32 Index)
+{
+	Locations.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Velocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	QuietFrames.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Roles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	RemoteRoles.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Radii.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HalfHeights.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CellKeys.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	CrowdVelocities.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	Significances.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	LODs.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+}
+
+bool FVortexMoverHotState::IsCrowdMember(int32 Index) const
+{
+	return Roles[Index] == ROLE_Authority && RemoteRoles[Index] != ROLE_AutonomousProxy;
+}
+
+void UVortexMoverSubsystem::Tick(float DeltaTime)
+{
+	const int32 NumMovers = Movers.Num();
+	SET_DWORD_STAT(STAT_VortexMovers, NumMovers);
+	if (NumMovers == 0)
+	{
+		return;
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VortexSubsystemGather);
+		Gather();
+	}
+
+	const bool bCrowdEnabled = VortexMoverCVars::IsCrowdEnabled();
+	if (bCrowdEnabled)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VortexSubsystemCrowd);
+
+		const int32 BatchSize = FMath::Max(VortexMoverCVars::GetSubsystemBatchSize(), 1);
+		const int32 NumBatches = FMath::DivideAndRoundUp(NumMovers, BatchSize);
+		const EParallelForFlags Flags = VortexMoverCVars::IsSubsystemParallelEnabled() ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+
+		UpdateSpatialHash();
+		bCrowdActive = true;
+
+		float MaxRadius = 0.0f;
+		for (const float Radius : HotState.Radii)
+		{
+			MaxRadius = FMath::Max(MaxRadius, Radius);
+		}
+
+		ParallelFor(NumBatches, [this, BatchSize, NumMovers, MaxRadius, DeltaTime](int32 BatchIndex)
+		{
+			const int32 Begin = BatchIndex * BatchSize;
+			ResolveCrowd(Begin, FMath::Min(Begin + BatchSize, NumMovers), MaxRadius, DeltaTime);
+		}, Flags);
+	}
+	else if (bCrowdActive)
+	{
+		SpatialHash.Reset();
+		for (FVector& CrowdVelocity : HotState.CrowdVelocities)
+		{
+			CrowdVelocity = FVector::ZeroVector;
+		}
+		bCrowdActive = false;
+	}
+
+	UpdateProxyLODs();
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_VortexSubsystemWriteBack);
+		WriteBack(DeltaTime);
+	}
+}
+
+TStatId UVortexMoverSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVortexMoverSubsystem, STATGROUP_VortexMover);
+}
+
+bool UVortexMoverSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UVortexMoverSubsystem::RegisterMover(UVortexMoverComponent* Mover)
+{
+	if (!Mover || Mover->GetHotStateIndex() != INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 Index = HotState.Add();
+	Movers.Add(Mover);
+	Mover->SetHotStateIndex(Index);
+
+	if (const USceneComponent* UpdatedComponent = Mover->GetUpdatedComponent())
+	{
+		HotState.Locations[Index] = UpdatedComponent->GetComponentLocation();
+	}
+
+	if (bCrowdActive)
+	{
+		HotState.CellKeys[Index] = SpatialHash.GetCellKey(HotState.Locations[Index]);
+		SpatialHash.Add(Index, HotState.CellKeys[Index]);
+	}
+}
+
+void UVortexMoverSubsystem::UnregisterMover(UVortexMoverComponent* Mover)
+{
+	const int32 Index = Mover ? Mover->GetHotStateIndex() : INDEX_NONE;
+	if (!Movers.IsValidIndex(Index) || Movers[Index] != Mover)
+	{
+		return;
+	}
+
+	if (bCrowdActive)
+	{
+		SpatialHash.Remove(Index, HotState.CellKeys[Index]);
+		const int32 LastIndex = HotState.Num() - 1;
+		if (LastIndex != Index)
+		{
+			SpatialHash.Reindex(LastIndex, Index, HotState.CellKeys[LastIndex]);
+		}
+	}
+
+	Movers.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	HotState.RemoveAtSwap(Index);
+	Mover->SetHotStateIndex(INDEX_NONE);
+
+	// The last mover took the freed slot
+	if (Movers.IsValidIndex(Index))
+	{
+		Movers[Index]->SetHotStateIndex(Index);
+	}
+}
+
+int32 UVortexMoverSubsystem::RewindMovers(const FVector& Origin, float Radius, double Time, TArrayView<FVortexRewoundMover> OutMovers) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_VortexSubsystemRewind);
+
+	const double MaxSpeed = VortexMoverCVars::GetLagCompMaxSpeed();
+	const double RadiusSq = FMath::Square(Radius);
+
+	int32 NumFound = 0;
+	for (int32 Index = 0; Index < Movers.Num() && NumFound < OutMovers.Num(); ++Index)
+	{
+		UVortexMoverComponent* Mover = Movers[Index];
+		if (!Mover)
+		{
+			continue;
+		}
+
+		// Nobody can have covered more than this since Time, skips rewinding movers that are far away now
+		const double MaxTravel = FMath::Max(Mover->GetHistory().GetNewestTime() - Time, 0.0) * MaxSpeed;
+		if (FVector::DistSquared(HotState.Locations[Index], Origin) > FMath::Square(Radius + MaxTravel))
+		{
+			continue;
+		}
+
+		FVortexRewoundMover& Result = OutMovers[NumFound];
+		if (!Mover->GetHistory().Evaluate(Time, Result.Location, Result.Rotation, Result.Velocity)
+			|| FVector::DistSquared(Result.Location, Origin) > RadiusSq)
+		{
+			continue;
+		}
+
+		Result.Mover = Mover;
+		Result.Radius = HotState.Radii[Index];
+		Result.HalfHeight = HotState.HalfHeights[Index];
+		++NumFound;
+	}
+	return NumFound;
+}
+
+void UVortexMoverSubsystem::Gather()
+{
+	// A few component reads per mover: cheaper in one pass than handing them to worker threads
+	for (int32 Index = 0; Index < Movers.Num(); ++Index)
+	{
+		const UVortexMoverComponent* Mover = Movers[Index];
+		const USceneComponent* UpdatedComponent = Mover ? Mover->GetUpdatedComponent() : nullptr;
+		if (!UpdatedComponent)
+		{
+			continue;
+		}
+
+		const FVector Location = UpdatedComponent->GetComponentLocation();
+		const FVector Velocity = Mover->GetVelocity();
+		const FVector FrameDelta = Location - HotState.Locations[Index];
+
+		HotState.Locations[Index] = Location;
+		HotState.Velocities[Index] = Velocity;
+		HotState.Roles[Index] = static_cast<uint8>(Mover->GetOwnerRole());
+		HotState.RemoteRoles[Index] = static_cast<uint8>(Mover->GetOwner()->GetRemoteRole());
+
+		if (const UCapsuleComponent* Capsule = Cast<UCapsuleComponent>(UpdatedComponent))
+		{
+			HotState.Radii[Index] = Capsule->GetScaledCapsuleRadius();
+			HotState.HalfHeights[Index] = Capsule->GetScaledCapsuleHalfHeight();
+		}
+		else
+		{
+			const FVector Extent = UpdatedComponent->Bounds.BoxExtent;
+			HotState.Radii[Index] = FMath::Max(Extent.X, Extent.Y);
+			HotState.HalfHeights[Index] = Extent.Z;
+		}
+
+		const bool bQuiet = FrameDelta.SizeSquared() <= QuietDistanceSq && Velocity.SizeSquared() <= QuietSpeedSq;
+		uint16& QuietFrames = HotState.QuietFrames[Index];
+		QuietFrames = bQuiet ? static_cast<uint16>(FMath::Min<int32>(QuietFrames + 1, MAX_uint16)) : 0;
+	}
+}
+
+void UVortexMoverSubsystem::UpdateSpatialHash()
+{
+	const bool bRebuild = SpatialHash.SetCellSize(VortexMoverCVars::GetCrowdCellSize()) || !bCrowdActive;
+	if (bRebuild)
+	{
+		SpatialHash.Reset();
+	}
+
+	for (int32 Index = 0; Index < HotState.Num(); ++Index)
+	{
+		const uint64 CellKey = SpatialHash.GetCellKey(HotState.Locations[Index]);
+		if (bRebuild)
+		{
+			SpatialHash.Add(Index, CellKey);
+		}
+		else if (CellKey != HotState.CellKeys[Index])
+		{
+			SpatialHash.Move(Index, HotState.CellKeys[Index], CellKey);
+		}
+		HotState.CellKeys[Index] = CellKey;
+	}
+}
+
+void UVortexMoverSubsystem::ResolveCrowd(int32 Begin, int32 End, float MaxRadius, float DeltaTime)
+{
+	const float Margin = FMath::Max(VortexMoverCVars::GetCrowdAvoidanceMargin(), 0.0f);
+	const float AvoidanceSpeed = VortexMoverCVars::GetCrowdAvoidanceSpeed();
+	const float MaxPushSpeed = VortexMoverCVars::GetCrowdMaxPushSpeed();
+	const float InvDeltaTime = DeltaTime > UE_SMALL_NUMBER ? 1.0f / DeltaTime : 0.0f;
+
+	for (int32 Index = Begin; Index < End; ++Index)
+	{
+		FVector& CrowdVelocity = HotState.CrowdVelocities[Index];
+		CrowdVelocity = FVector::ZeroVector;
+
+		// Only movers no client predicts are pushed (AI, bots, the listen server's own pawn). A player's client could not
+		// predict the push and would be corrected on every contact, players keep colliding with everyone as before.
+		if (!HotState.IsCrowdMember(Index))
+		{
+			continue;
+		}
+
+		const FVector Location = HotState.Locations[Index];
+		const float Radius = HotState.Radii[Index];
+		const float HalfHeight = HotState.HalfHeights[Index];
+
+		SpatialHash.ForEachNearby(Location, Radius + MaxRadius + Margin, [&](int32 Other)
+		{
+			if (Other == Index || FMath::Abs(Location.Z - HotState.Locations[Other].Z) >= HalfHeight + HotState.HalfHeights[Other])
+			{
+				return;
+			}
+
+			const FVector Delta(Location.X - HotState.Locations[Other].X, Location.Y - HotState.Locations[Other].Y, 0.0);
+			const double Contact = Radius + HotState.Radii[Other];
+			const double DistanceSq = Delta.SizeSquared();
+			if (DistanceSq >= FMath::Square(Contact + Margin))
+			{
+				return;
+			}
+
+			// Stacked exactly on top of each other: split along X, the lower slot goes the other way
+			const double Distance = FMath::Sqrt(DistanceSq);
+			const FVector Direction = Distance > UE_KINDA_SMALL_NUMBER ? Delta / Distance : (Index < Other ? -FVector::XAxisVector : FVector::XAxisVector);
+
+			// Two crowd members resolve the same pair and each take half of the overlap, a player does not yield
+			if (Distance < Contact)
+			{
+				const double Share = HotState.IsCrowdMember(Other) ? 0.5 : 1.0;
+				CrowdVelocity += Direction * (Share * (Contact - Distance) * InvDeltaTime);
+			}
+			if (Margin > 0.0f)
+			{
+				CrowdVelocity += Direction * (AvoidanceSpeed * (1.0 - FMath::Max(Distance - Contact, 0.0) / Margin));
+			}
+		});
+
+		CrowdVelocity = CrowdVelocity.GetClampedToMaxSize(MaxPushSpeed);
+	}
+}
+
+void UVortexMoverSubsystem::UpdateProxyLODs()
+{
+	SCOPE_CYCLE_COUNTER(STAT_VortexSubsystemLOD);
+
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (!VortexMoverCVars::IsLODEnabled() || !PlayerController)
+	{
+		for (uint8& LOD : HotState.LODs)
+		{
+			LOD = static_cast<uint8>(EVortexMoverLOD::Full);
+		}
+		return;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	const float OffscreenScaleSq = FMath::Square(VortexMoverCVars::GetLODOffscreenScale());
+	const double ReducedDistanceSq = FMath::Square(VortexMoverCVars::GetLODReducedDistance());
+
+	ProxyRanking.Reset();
+	for (int32 Index = 0; Index < Movers.Num(); ++Index)
+	{
+		uint8& LOD = HotState.LODs[Index];
+		const UVortexMoverComponent* Mover = Movers[Index];
+		if (!Mover || HotState.Roles[Index] != ROLE_SimulatedProxy)
+		{
+			LOD = static_cast<uint8>(EVortexMoverLOD::Full);
+			continue;
+		}
+
+		const UPrimitiveComponent* Visual = Cast<UPrimitiveComponent>(Mover->GetPrimaryVisualComponent());
+		const bool bOnScreen = !Visual || Visual->WasRecentlyRendered(0.2f);
+		const double DistanceSq = FVector::DistSquared(HotState.Locations[Index], ViewLocation);
+
+		HotState.Significances[Index] = static_cast<float>(bOnScreen ? DistanceSq : DistanceSq * OffscreenScaleSq);
+		LOD = static_cast<uint8>(bOnScreen && DistanceSq <= ReducedDistanceSq ? EVortexMoverLOD::Reduced : EVortexMoverLOD::Snap);
+		ProxyRanking.Add(Index);
+	}
+
+	// The budget goes to the most significant proxies, whatever tier distance alone gave them
+	const int32 NumFull = FMath::Clamp(VortexMoverCVars::GetLODFullMovers(), 0, ProxyRanking.Num());
+	if (NumFull < ProxyRanking.Num())
+	{
+		ProxyRanking.Sort([this](int32 A, int32 B) { return HotState.Significances[A] < HotState.Significances[B]; });
+	}
+	for (int32 Rank = 0; Rank < NumFull; ++Rank)
+	{
+		HotState.LODs[ProxyRanking[Rank]] = static_cast<uint8>(EVortexMoverLOD::Full);
+	}
+}
+
+void UVortexMoverSubsystem::WriteBack(float DeltaTime)
+{
+	const ENetMode NetMode = GetWorld()->GetNetMode();
+	const bool bNetServer = NetMode == NM_DedicatedServer || NetMode == NM_ListenServer;
+	double MaxProxyDelay = 0.0;
+
+	for (int32 Index = 0; Index < Movers.Num(); ++Index)
+	{
+		UVortexMoverComponent* Mover = Movers[Index];
+		if (!Mover)
+		{
+			continue;
+		}
+
+		if (HotState.Roles[Index] == ROLE_Authority)
+		{
+			Mover->SendInputAck();
+			Mover->UpdateProxyState();
+
+			if (bNetServer)
+			{
+				Mover->UpdateNetUpdateFrequency(HotState.Velocities[Index], HotState.QuietFrames[Index], DeltaTime);
+			}
+		}
+
+		// Zero while the crowd pass is off
+		Mover->SetCrowdVelocity(HotState.CrowdVelocities[Index]);
+
+		if (HotState.Roles[Index] == ROLE_SimulatedProxy)
+		{
+			const EVortexMoverLOD LOD = static_cast<EVortexMoverLOD>(HotState.LODs[Index]);
+			INC_DWORD_STAT_BY(STAT_VortexProxiesFull, LOD == EVortexMoverLOD::Full ? 1 : 0);
+			INC_DWORD_STAT_BY(STAT_VortexProxiesReduced, LOD == EVortexMoverLOD::Reduced ? 1 : 0);
+			INC_DWORD_STAT_BY(STAT_VortexProxiesSnap, LOD == EVortexMoverLOD::Snap ? 1 : 0);
+
+			Mover->SetProxyLOD(LOD);
+			Mover->UpdateProxySmoothing(DeltaTime);
+			MaxProxyDelay = FMath::Max(MaxProxyDelay, Mover->GetProxyInterpolationDelay());
+		}
+
+		// Snapshot for ProduceInput calls made off the game thread (async simulation), a no-op for pawns nobody controls locally
+		if (UVortexInputProducer* Producer = Cast<UVortexInputProducer>(Mover->InputProducer))
+		{
+			Producer->PublishOwnerState();
+		}
+	}
+
+	CSV_CUSTOM_STAT(VortexMover, ProxyInterpolationDelayMs, static_cast<float>(MaxProxyDelay * 1000.0), ECsvCustomStatOp::Set);
+}
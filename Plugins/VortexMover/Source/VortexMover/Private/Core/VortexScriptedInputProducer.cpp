@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/VortexScriptedInputProducer.h"
+
+#include "Core/VortexInputDataTypes.h"
+#include "Math/RandomStream.h"
+
+void UVortexScriptedInputProducer::ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult)
+{
+	// Reset events from Initialize/unpossess would otherwise pile up in the base class queue
+	DiscardPendingEvents();
+
+	FVortexInputCmd& Cmd = InputCmdResult.InputCollection.FindOrAddMutableDataByType<FVortexInputCmd>();
+	if (ProduceReplayedInput(SimTimeMs, Cmd))
+	{
+		StampInputFrame(Cmd);
+		return;
+	}
+
+	const FSample Current = Sample(SimTimeMs);
+	// Edge against the previous produced frame, sampled again rather than remembered so restarts stay deterministic
+	const bool bWasJumpHeld = bHasLastSample && SimTimeMs > LastSimTimeMs && Sample(LastSimTimeMs).bJumpHeld;
+	LastSimTimeMs = SimTimeMs;
+	bHasLastSample = true;
+
+	Cmd.SetControlRotation(FRotator(0.0f, Current.Yaw, 0.0f));
+	Cmd.SetMoveInput(Cmd.ControlRotation.RotateVector(FVector(Current.Move.X, Current.Move.Y, 0.0f)));
+	Cmd.bJumpPressed = Current.bJumpHeld;
+	Cmd.bJumpJustPressed = Current.bJumpHeld && !bWasJumpHeld;
+	Cmd.bCrouchPressed = Current.bCrouchHeld;
+	StampInputFrame(Cmd);
+}
+
+UVortexScriptedInputProducer::FSample UVortexScriptedInputProducer::Sample(int32 SimTimeMs) const
+{
+	const double Time = FMath::Max(SimTimeMs, 0) / 1000.0;
+	return Steps.IsEmpty() ? SampleRandom(Time) : SampleSteps(Time);
+}
+
+UVortexScriptedInputProducer::FSample UVortexScriptedInputProducer::SampleSteps(double Time) const
+{
+	double LoopDuration = 0.0;
+	double LoopYaw = 0.0;
+	for (const FVortexScriptedInputStep& Step : Steps)
+	{
+		LoopDuration += FMath::Max(Step.Duration, 0.01f);
+		LoopYaw += Step.YawRate * FMath::Max(Step.Duration, 0.01f);
+	}
+
+	const double NumLoops = FMath::FloorToDouble(Time / LoopDuration);
+	double LocalTime = Time - NumLoops * LoopDuration;
+	double Yaw = FMath::Fmod(LoopYaw * NumLoops, 360.0);
+
+	FSample Result;
+	for (const FVortexScriptedInputStep& Step : Steps)
+	{
+		const double Duration = FMath::Max(Step.Duration, 0.01f);
+		if (LocalTime < Duration || &Step == &Steps.Last())
+		{
+			Result.Move = Step.Move.ClampAxes(-1.0, 1.0);
+			Result.Yaw = static_cast<float>(Yaw + Step.YawRate * LocalTime);
+			Result.bJumpHeld = Step.bJump && LocalTime < JumpHoldTime;
+			Result.bCrouchHeld = Step.bCrouch;
+			break;
+		}
+		LocalTime -= Duration;
+		Yaw += Step.YawRate * Duration;
+	}
+	return Result;
+}
+
+UVortexScriptedInputProducer::FSample UVortexScriptedInputProducer::SampleRandom(double Time) const
+{
+	const int32 StepIndex = FMath::FloorToInt32(Time / RandomStepDuration);
+	const double LocalTime = Time - StepIndex * static_cast<double>(RandomStepDuration);
+
+	// Every step draws from its own stream, no state carried between steps
+	FRandomStream Stream(static_cast<int32>(HashCombineFast(GetTypeHash(Seed), GetTypeHash(StepIndex))));
+
+	FSample Result;
+	Result.Yaw = Stream.FRandRange(0.0f, 360.0f);
+	const bool bIdle = Stream.FRand() < IdleChance;
+	const float Speed = Stream.FRandRange(0.5f, 1.0f);
+	const float Strafe = Stream.FRandRange(-0.5f, 0.5f);
+	Result.Move = bIdle ? FVector2D::ZeroVector : FVector2D(Speed, Strafe);
+	Result.bJumpHeld = Stream.FRand() < JumpChance && LocalTime < JumpHoldTime;
+	Result.bCrouchHeld = Stream.FRand() < CrouchChance;
+	return Result;
+}
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Core/VortexSnapshotBuffer.h"
+
+#include "Core/VortexInputDataTypes.h"
+#include "MoveLibrary/FloorQueryUtils.h"
+#include "MoverDataModelTypes.h"
+#include "MoverSimulationTypes.h"
+
+namespace
+{
+	// How far a start state may be from a recorded end state and still count as the same, about what the float storage loses
+	constexpr float LocationTolerance = 0.02f;
+	constexpr float VelocityTolerance = 0.02f;
+	constexpr float ProposedMoveTolerance = 0.02f;
+
+	int8 QuantizeMoveInput(double Value)
+	{
+		return static_cast<int8>(FMath::Clamp(FMath::RoundToInt(Value * 100.0), -127, 127));
+	}
+
+	uint8 GetButtons(const FVortexInputCmd* Cmd)
+	{
+		return !Cmd ? 0 : (Cmd->bJumpPressed ? FVortexSnapshot::JumpPressed : 0)
+			| (Cmd->bJumpJustPressed ? FVortexSnapshot::JumpJustPressed : 0)
+			| (Cmd->bCrouchPressed ? FVortexSnapshot::CrouchPressed : 0);
+	}
+
+	FVector3f ToVector(const FRotator& Rotator)
+	{
+		return FVector3f(Rotator.Pitch, Rotator.Yaw, Rotator.Roll);
+	}
+}
+
+void FVortexSnapshot::SetSyncState(const FMoverDefaultSyncState& SyncState)
+{
+	const FRotator Orientation = SyncState.GetOrientation_WorldSpace();
+	Location = FVector3f(SyncState.GetLocation_WorldSpace());
+	Velocity = FVector3f(SyncState.GetVelocity_WorldSpace());
+	Pitch = FRotator::CompressAxisToShort(Orientation.Pitch);
+	Yaw = FRotator::CompressAxisToShort(Orientation.Yaw);
+	Roll = FRotator::CompressAxisToShort(Orientation.Roll);
+}
+
+void FVortexSnapshot::GetSyncState(FMoverDefaultSyncState& OutSyncState) const
+{
+	const FRotator Orientation(FRotator::DecompressAxisFromShort(Pitch), FRotator::DecompressAxisFromShort(Yaw), FRotator::DecompressAxisFromShort(Roll));
+	OutSyncState.SetTransforms_WorldSpace(FVector(Location), Orientation, FVector(Velocity));
+}
+
+bool FVortexSnapshot::MatchesSyncState(const FMoverDefaultSyncState& SyncState) const
+{
+	const FRotator Orientation = SyncState.GetOrientation_WorldSpace();
+	return FRotator::CompressAxisToShort(Orientation.Pitch) == Pitch
+		&& FRotator::CompressAxisToShort(Orientation.Yaw) == Yaw
+		&& FRotator::CompressAxisToShort(Orientation.Roll) == Roll
+		&& FVector3f(SyncState.GetLocation_WorldSpace()).Equals(Location, LocationTolerance)
+		&& FVector3f(SyncState.GetVelocity_WorldSpace()).Equals(Velocity, VelocityTolerance);
+}
+
+void FVortexSnapshot::SetInput(const FVortexInputCmd* Cmd, const FProposedMove& ProposedMove)
+{
+	const FVector MoveInput = Cmd ? Cmd->GetMoveInput() : FVector::ZeroVector;
+	MoveInputX = QuantizeMoveInput(MoveInput.X);
+	MoveInputY = QuantizeMoveInput(MoveInput.Y);
+	MoveInputZ = QuantizeMoveInput(MoveInput.Z);
+	Buttons = GetButtons(Cmd);
+	ProposedVelocity = FVector3f(ProposedMove.LinearVelocity);
+	ProposedAngularVelocity = ToVector(ProposedMove.AngularVelocity);
+}
+
+bool FVortexSnapshot::MatchesInput(const FVortexInputCmd* Cmd, const FProposedMove& ProposedMove) const
+{
+	const FVector MoveInput = Cmd ? Cmd->GetMoveInput() : FVector::ZeroVector;
+	return QuantizeMoveInput(MoveInput.X) == MoveInputX
+		&& QuantizeMoveInput(MoveInput.Y) == MoveInputY
+		&& QuantizeMoveInput(MoveInput.Z) == MoveInputZ
+		&& GetButtons(Cmd) == Buttons
+		&& FVector3f(ProposedMove.LinearVelocity).Equals(ProposedVelocity, ProposedMoveTolerance)
+		&& ToVector(ProposedMove.AngularVelocity).Equals(ProposedAngularVelocity, ProposedMoveTolerance);
+}
+
+void FVortexSnapshot::SetFloor(const FFloorCheckResult& Floor)
+{
+	bWalkableFloor = Floor.IsWalkableFloor();
+	FloorDist = Floor.FloorDist;
+	FloorNormal = FVector3f(Floor.HitResult.ImpactNormal);
+	FloorPrimitive = Floor.HitResult.GetComponent();
+}
+
+bool FVortexSnapshot::GetFloor(const FVector& InLocation, FFloorCheckResult& OutFloor) const
+{
+	if (!bWalkableFloor)
+	{
+		return false;
+	}
+
+	OutFloor = FFloorCheckResult();
+	OutFloor.bBlockingHit = true;
+	OutFloor.bWalkableFloor = true;
+	OutFloor.FloorDist = FloorDist + static_cast<float>(InLocation.Z - Location.Z);
+	OutFloor.HitResult.bBlockingHit = true;
+	OutFloor.HitResult.Normal = FVector(FloorNormal);
+	OutFloor.HitResult.ImpactNormal = FVector(FloorNormal);
+	OutFloor.HitResult.Component = FloorPrimitive;
+	return true;
+}
+
+void FVortexSnapshotBuffer::Init(int32 InCapacity)
+{
+	Snapshots.Reset();
+	Snapshots.SetNum(FMath::Max(InCapacity, 1));
+}
+
+FVortexSnapshot* FVortexSnapshotBuffer::Write(int32 Frame)
+{
+	if (Snapshots.IsEmpty() || Frame < 0)
+	{
+		return nullptr;
+	}
+
+	FVortexSnapshot& Snapshot = Snapshots[Frame % Snapshots.Num()];
+	Snapshot = FVortexSnapshot();
+	Snapshot.Frame = Frame;
+	return &Snapshot;
+}
+
+const FVortexSnapshot* FVortexSnapshotBuffer::Find(int32 Frame) const
+{
+	if (Snapshots.IsEmpty() || Frame < 0)
+	{
+		return nullptr;
+	}
+
+	const FVortexSnapshot& Snapshot = Snapshots[Frame % Snapshots.Num()];
+	return Snapshot.Frame == Frame ? &Snapshot : nullptr;
+}
@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CoreMinimal.h"
+
+#if !UE_BUILD_SHIPPING
+
+#include "HAL/IConsoleManager.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "InputActionValue.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "UObject/CoreNet.h"
+#include "UObject/Package.h"
+#include "UObject/StrongObjectPtr.h"
+#include "VortexMoverLogChannels.h"
+#include "Core/VortexInputDataTypes.h"
+#include "Core/VortexInputProducer.h"
+#include "Core/VortexScriptedInputProducer.h"
+
+/**
+ * vortex.bench.InputCmd [Iterations] [SaveBaseline]
+ *
+ * -Times the FVortexInputCmd hot path (NetSerialize, Interpolate, Merge, Decay, Clone, ShouldReconcile) and ProduceInput
+ * -Reports ns/op and pooled cmd heap allocs/op: FVortexInputCmd clones that missed TVortexDataStructPool and went to the heap.
+ *  No other allocation is counted, they are only tagged Vortex/Benchmark for LLM and memory trace (-llm, -trace=memalloc).
+ * -Reports the change against the saved baseline
+ * -Baseline: Saved/VortexBench/InputCmdBaseline.csv, written when SaveBaseline is passed
+ * -Headless: -nullrhi -ExecCmds="vortex.bench.InputCmd 5000000, quit"
+ * -A console command, not an automation test. Blocks the game thread for the whole run, development tool only
+ */
+namespace
+{
+	using FInputCmdPool = TVortexDataStructPool<FVortexInputCmd>;
+
+	struct FBenchResult
+	{
+		FString Name;
+		double NsPerOp = 0.0;
+		double CmdHeapAllocsPerOp = 0.0;
+	};
+
+	// Keeps results observable so the measured calls can't be optimized out
+	volatile int32 GBenchSink = 0;
+
+	void Consume(int32 Value)
+	{
+		GBenchSink = GBenchSink + Value;
+	}
+
+	template <typename FuncType>
+	FBenchResult RunBenchmark(const TCHAR* Name, int32 Iterations, FuncType&& Func)
+	{
+		// Warm caches, pools and lazily allocated buffers before measuring
+		for (int32 Index = 0; Index < FMath::Min(Iterations, 1000); ++Index)
+		{
+			Func(Index);
+		}
+
+		LLM_SCOPE_BYNAME(TEXT("Vortex/Benchmark"));
+		const uint64 StartHeapAllocations = FInputCmdPool::GetNumHeapAllocations();
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		for (int32 Index = 0; Index < Iterations; ++Index)
+		{
+			Func(Index);
+		}
+		const uint64 EndCycles = FPlatformTime::Cycles64();
+
+		FBenchResult Result;
+		Result.Name = Name;
+		Result.NsPerOp = FPlatformTime::ToSeconds64(EndCycles - StartCycles) * 1.0e9 / Iterations;
+		Result.CmdHeapAllocsPerOp = static_cast<double>(FInputCmdPool::GetNumHeapAllocations() - StartHeapAllocations) / Iterations;
+		return Result;
+	}
+
+	FString GetBaselinePath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("VortexBench") / TEXT("InputCmdBaseline.csv");
+	}
+
+	TMap<FString, FBenchResult> LoadBaseline()
+	{
+		TMap<FString, FBenchResult> Baseline;
+		TArray<FString> Lines;
+		if (!FFileHelper::LoadFileToStringArray(Lines, *GetBaselinePath()))
+		{
+			return Baseline;
+		}
+
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Columns;
+			if (Line.ParseIntoArray(Columns, TEXT(",")) == 3 && Columns[0] != TEXT("Name"))
+			{
+				FBenchResult& Entry = Baseline.Add(Columns[0]);
+				Entry.Name = Columns[0];
+				Entry.NsPerOp = FCString::Atod(*Columns[1]);
+				Entry.CmdHeapAllocsPerOp = FCString::Atod(*Columns[2]);
+			}
+		}
+		return Baseline;
+	}
+
+	void SaveBaseline(const TArray<FBenchResult>& Results)
+	{
+		TArray<FString> Lines;
+		Lines.Add(TEXT("Name,NsPerOp,CmdHeapAllocsPerOp"));
+		for (const FBenchResult& Result : Results)
+		{
+			Lines.Add(FString::Printf(TEXT("%s,%.3f,%.4f"), *Result.Name, Result.NsPerOp, Result.CmdHeapAllocsPerOp));
+		}
+
+		if (FFileHelper::SaveStringArrayToFile(Lines, *GetBaselinePath()))
+		{
+			UE_LOG(LogVortexMover, Display, TEXT("Saved baseline %s"), *GetBaselinePath());
+		}
+		else
+		{
+			UE_LOG(LogVortexMover, Warning, TEXT("Failed to save baseline %s"), *GetBaselinePath());
+		}
+	}
+
+	void RunInputCmdBenchmarks(const TArray<FString>& Args)
+	{
+		const int32 Iterations = Args.IsValidIndex(0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000000;
+		const bool bSaveBaseline = Args.ContainsByPredicate([](const FString& Arg) { return Arg.Equals(TEXT("SaveBaseline"), ESearchCase::IgnoreCase); });
+
+		// Representative held input, and a second command that differs in every field
+		FVortexInputCmd CmdA;
+		CmdA.SetMoveInput(FVector(0.71, 0.71, 0.0));
+		CmdA.SetControlRotation(FRotator(-12.5, 37.5, 0.0));
+		CmdA.bJumpPressed = true;
+
+		FVortexInputCmd CmdB;
+		CmdB.SetMoveInput(FVector(-0.3, 0.9, 0.0));
+		CmdB.SetControlRotation(FRotator(5.0, 120.0, 0.0));
+		CmdB.bCrouchPressed = true;
+
+		const FMoverDataStructBase& BaseA = CmdA;
+		const FMoverDataStructBase& BaseB = CmdB;
+
+		TArray<FBenchResult> Results;
+
+		{
+			FVortexInputCmd Cmd = CmdA;
+			FNetBitWriter Writer(nullptr, 1024);
+			FBitWriterMark Mark(Writer);
+			Results.Add(RunBenchmark(TEXT("NetSerialize.Write"), Iterations, [&](int32)
+			{
+				bool bOutSuccess = false;
+				Cmd.NetSerialize(Writer, nullptr, bOutSuccess);
+				Consume(static_cast<int32>(Writer.GetNumBits()));
+				Mark.Pop(Writer);
+			}));
+		}
+
+		{
+			FNetBitWriter Writer(nullptr, 1024);
+			bool bOutSuccess = false;
+			FVortexInputCmd(CmdA).NetSerialize(Writer, nullptr, bOutSuccess);
+
+			FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+			FBitReaderMark Mark(Reader);
+			FVortexInputCmd Cmd;
+			Results.Add(RunBenchmark(TEXT("NetSerialize.Read"), Iterations, [&](int32)
+			{
+				Cmd.NetSerialize(Reader, nullptr, bOutSuccess);
+				Consume(Cmd.bJumpPressed);
+				Mark.Pop(Reader);
+			}));
+		}
+
+		{
+			FVortexInputCmd Cmd;
+			FMoverDataStructBase& Base = Cmd;
+			Results.Add(RunBenchmark(TEXT("Interpolate"), Iterations, [&](int32 Index)
+			{
+				Base.Interpolate(BaseA, BaseB, (Index & 255) / 255.0f);
+				Consume(Cmd.bJumpPressed);
+			}));
+		}
+
+		{
+			FVortexInputCmd Cmd = CmdB;
+			FMoverDataStructBase& Base = Cmd;
+			Results.Add(RunBenchmark(TEXT("Merge"), Iterations, [&](int32)
+			{
+				Base.Merge(BaseA);
+				Consume(Cmd.bJumpPressed);
+			}));
+		}
+
+		{
+			FVortexInputCmd Cmd = CmdA;
+			FMoverDataStructBase& Base = Cmd;
+			Results.Add(RunBenchmark(TEXT("Decay"), Iterations, [&](int32)
+			{
+				// Repeated decay would drive the move input into denormals, always decay the held input
+				Cmd = CmdA;
+				Base.Decay(0.5f);
+				Consume(Cmd.bJumpJustPressed);
+			}));
+		}
+
+		Results.Add(RunBenchmark(TEXT("Clone"), Iterations, [&](int32)
+		{
+			FMoverDataStructBase* Clone = BaseA.Clone();
+			Consume(Clone != nullptr);
+			delete Clone;
+		}));
+
+		Results.Add(RunBenchmark(TEXT("ShouldReconcile"), Iterations, [&](int32 Index)
+		{
+			Consume(BaseA.ShouldReconcile((Index & 1) ? BaseA : BaseB));
+		}));
+
+		{
+			// Without a pawn this covers draining and integrating the event queue, then the early out for non local pawns
+			TStrongObjectPtr<UVortexInputProducer> Producer(NewObject<UVortexInputProducer>(GetTransientPackage()));
+			FMoverInputCmdContext Context;
+			const FInputActionValue MoveValue(FVector2D(0.5, 1.0));
+			Results.Add(RunBenchmark(TEXT("ProduceInput.Events"), Iterations, [&](int32 Index)
+			{
+				Producer->OnMove(MoveValue);
+				Producer->ProduceInput_Implementation(Index * 16, Context);
+			}));
+		}
+
+		{
+			TStrongObjectPtr<UVortexScriptedInputProducer> Producer(NewObject<UVortexScriptedInputProducer>(GetTransientPackage()));
+			FMoverInputCmdContext Context;
+			Results.Add(RunBenchmark(TEXT("ProduceInput.Scripted"), Iterations, [&](int32 Index)
+			{
+				Producer->ProduceInput_Implementation(Index * 16, Context);
+			}));
+		}
+
+		const TMap<FString, FBenchResult> Baseline = LoadBaseline();
+		UE_LOG(LogVortexMover, Display, TEXT("FVortexInputCmd benchmarks, %d iterations:"), Iterations);
+		for (const FBenchResult& Result : Results)
+		{
+			const FBenchResult* Previous = Baseline.Find(Result.Name);
+			if (Previous && Previous->NsPerOp > 0.0)
+			{
+				UE_LOG(LogVortexMover, Display, TEXT("  %-24s %9.2f ns/op %+7.1f%%  %6.3f pooled cmd heap allocs/op (baseline %.3f)"),
+					*Result.Name, Result.NsPerOp, 100.0 * (Result.NsPerOp - Previous->NsPerOp) / Previous->NsPerOp, Result.CmdHeapAllocsPerOp, Previous->CmdHeapAllocsPerOp);
+			}
+			else
+			{
+				UE_LOG(LogVortexMover, Display, TEXT("  %-24s %9.2f ns/op           %6.3f pooled cmd heap allocs/op"), *Result.Name, Result.NsPerOp, Result.CmdHeapAllocsPerOp);
+			}
+		}
+
+		if (bSaveBaseline)
+		{
+			SaveBaseline(Results);
+		}
+	}
+
+	FAutoConsoleCommand CmdVortexInputCmdBenchmark(
+		TEXT("vortex.bench.InputCmd"),
+		TEXT("Times the FVortexInputCmd hot path and ProduceInput, reports ns/op, pooled FVortexInputCmd heap allocations/op (pool misses only) and the change against the saved baseline.\n")
+		TEXT("Usage: vortex.bench.InputCmd [Iterations=1000000] [SaveBaseline]\n"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&RunInputCmdBenchmarks));
+}
+
+#endif // !UE_BUILD_SHIPPING
@@ -0,0 +1,371 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Modes/VortexWalkingMode.h"
+
+#include "Core/VortexInputDataTypes.h"
+#include "Core/VortexMoverComponent.h"
+#include "Modes/VortexWalkingSettings.h"
+#include "MoveLibrary/MovementUtils.h"
+#include "MoverComponent.h"
+#include "MoverDataModelTypes.h"
+#include "MoverSimulationTypes.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Floor Sweeps"), STAT_VortexFloorSweeps, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Floor Cache Hits"), STAT_VortexFloorCacheHits, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Floor Snapshot Restores"), STAT_VortexFloorSnapshotRestores, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Snapshot Replays"), STAT_VortexSnapshotReplays, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sleeping Ticks"), STAT_VortexSleepingTicks, STATGROUP_VortexMover);
+
+namespace
+{
+	// Same floor distance band as the character movement modes, the pawn is snapped down once it floats above the max
+	constexpr float MinFloorDist = 1.9f;
+	constexpr float MaxFloorDist = 2.4f;
+
+	bool IsNeutralInput(const FVortexInputCmd* Cmd)
+	{
+		return !Cmd || (Cmd->GetMoveInput().IsNearlyZero() && !Cmd->bJumpPressed && !Cmd->bCrouchPressed);
+	}
+
+	bool IsStaticPrimitive(const UPrimitiveComponent* Primitive)
+	{
+		return Primitive && Primitive->Mobility == EComponentMobility::Static;
+	}
+
+	// A hit a resimulated frame is sure to hit again: none, or static geometry
+	bool IsReplayableHit(const FHitResult& Hit)
+	{
+		return !Hit.IsValidBlockingHit() || IsStaticPrimitive(Hit.GetComponent());
+	}
+}
+
+const UVortexWalkingSettings* UVortexWalkingMode::GetSettings() const
+{
+	return Settings ? Settings.Get() : GetDefault<UVortexWalkingSettings>();
+}
+
+void UVortexWalkingMode::OnGenerateMove(const FMoverTickStartData& StartState, const FMoverTimeStep& TimeStep, FProposedMove& OutProposedMove) const
+{
+	const FMoverDefaultSyncState* SyncState = StartState.SyncState.SyncStateCollection.FindDataByType<FMoverDefaultSyncState>();
+	check(SyncState);
+
+	const FVortexInputCmd* Cmd = StartState.InputCmd.InputCollection.FindDataByType<FVortexInputCmd>();
+	// Asleep: nothing to propose, OnSimulationTick decides whether the pawn keeps sleeping
+	if (Sleep.bAsleep && !TimeStep.bIsResimulating && IsNeutralInput(Cmd) && SyncState->GetVelocity_WorldSpace().IsNearlyZero())
+	{
+		return;
+	}
+
+	const UVortexWalkingSettings& Tuning = *GetSettings();
+	const float DeltaSeconds = TimeStep.StepMs * 0.001f;
+
+	FVector MoveInput = Cmd ? Cmd->GetMoveInput() : FVector::ZeroVector;
+	MoveInput.Z = 0.0;
+	MoveInput = MoveInput.GetClampedToMaxSize(1.0);
+
+	const FVector Velocity = SyncState->GetVelocity_WorldSpace();
+	const FVector HorizontalVelocity(Velocity.X, Velocity.Y, 0.0);
+	const float Rate = MoveInput.IsNearlyZero() ? Tuning.Deceleration : Tuning.Acceleration;
+
+	OutProposedMove.LinearVelocity = FMath::VInterpConstantTo(HorizontalVelocity, MoveInput * Tuning.MaxSpeed, DeltaSeconds, Rate);
+	OutProposedMove.bHasDirIntent = !MoveInput.IsNearlyZero();
+	OutProposedMove.DirectionIntent = MoveInput.GetSafeNormal();
+
+	// Face the direction of travel, keep the current facing while standing still
+	const FRotator Orientation = SyncState->GetOrientation_WorldSpace();
+	const FRotator TargetOrientation = OutProposedMove.bHasDirIntent ? FRotator(0.0f, MoveInput.Rotation().Yaw, 0.0f) : Orientation;
+	OutProposedMove.AngularVelocity = UMovementUtils::ComputeAngularVelocity(Orientation, TargetOrientation, DeltaSeconds, Tuning.TurningRate);
+}
+
+void UVortexWalkingMode::OnSimulationTick(const FSimulationTickParams& Params, FMoverTickEndData& OutputState)
+{
+	USceneComponent* UpdatedComponent = Params.MovingComps.UpdatedComponent.Get();
+	UMoverComponent* MoverComponent = Params.MovingComps.MoverComponent.Get();
+	const FMoverDefaultSyncState* StartingSyncState = Params.StartState.SyncState.SyncStateCollection.FindDataByType<FMoverDefaultSyncState>();
+	check(StartingSyncState);
+	FMoverDefaultSyncState& OutputSyncState = OutputState.SyncState.SyncStateCollection.FindOrAddMutableDataByType<FMoverDefaultSyncState>();
+
+	const float DeltaSeconds = Params.TimeStep.StepMs * 0.001f;
+	OutputState.MovementEndState.RemainingMs = 0.0f;
+
+	if (!UpdatedComponent || !MoverComponent || DeltaSeconds <= 0.0f)
+	{
+		OutputSyncState = *StartingSyncState;
+		return;
+	}
+
+	// The push is not part of the sync or input state, so a resimulated frame could not replay the one it had. It only ever
+	// applies on the server (see UVortexMoverSubsystem's crowd pass), where frames are not resimulated.
+	UVortexMoverComponent* VortexMover = Cast<UVortexMoverComponent>(MoverComponent);
+	const FVector CrowdVelocity = VortexMover && !Params.TimeStep.bIsResimulating ? VortexMover->ConsumeCrowdVelocity() : FVector::ZeroVector;
+
+	// Resimulated frame that starts and runs exactly like the recorded one: take its end state, no sweeps
+	if (Params.TimeStep.bIsResimulating && ReplaySnapshot(Params, VortexMover, *StartingSyncState, OutputSyncState))
+	{
+		INC_DWORD_STAT(STAT_VortexSnapshotReplays);
+		return;
+	}
+
+	// Asleep: the pawn stays exactly where it is, no floor check and no move
+	if (UpdateSleep(Params, *StartingSyncState, CrowdVelocity))
+	{
+		INC_DWORD_STAT(STAT_VortexSleepingTicks);
+		if (VortexMover)
+		{
+			VortexMover->MarkSleepingTick();
+		}
+		OutputSyncState = *StartingSyncState;
+		RecordSnapshot(Params, VortexMover, OutputSyncState, FloorCache.Floor, IsStaticPrimitive(FloorCache.Primitive.Get()));
+		return;
+	}
+
+	FMovementRecord MoveRecord;
+	MoveRecord.SetDeltaSeconds(DeltaSeconds);
+
+	// The floor under the start location is what the previous tick ended on, normally a cache hit
+	const FVector StartLocation = StartingSyncState->GetLocation_WorldSpace();
+	FFloorCheckResult Floor;
+	FindFloor(Params, StartLocation, Floor);
+
+	FVector Velocity = Params.ProposedMove.LinearVelocity;
+	if (Floor.IsWalkableFloor())
+	{
+		Velocity = FVector::VectorPlaneProject(Velocity, Floor.HitResult.ImpactNormal);
+	}
+	else
+	{
+		Velocity.Z = StartingSyncState->GetVelocity_WorldSpace().Z;
+		Velocity += MoverComponent->GetGravityAcceleration() * DeltaSeconds;
+	}
+
+	const FVector MoveDelta = (Velocity + CrowdVelocity) * DeltaSeconds;
+	const FRotator StartOrientation = StartingSyncState->GetOrientation_WorldSpace();
+	const FRotator TargetOrientation = StartOrientation + Params.ProposedMove.AngularVelocity * DeltaSeconds;
+
+	// Standing still costs neither a move sweep nor, with the cache, a floor sweep
+	const bool bMoving = !MoveDelta.IsNearlyZero() || !TargetOrientation.Equals(StartOrientation);
+	bool bReplayable = CrowdVelocity.IsNearlyZero();
+	if (bMoving)
+	{
+		const FQuat TargetQuat = TargetOrientation.Quaternion();
+		FHitResult Hit(1.0f);
+		UMovementUtils::TrySafeMoveUpdatedComponent(Params.MovingComps, MoveDelta, TargetQuat, true, Hit, ETeleportType::None, MoveRecord);
+		if (Hit.IsValidBlockingHit())
+		{
+			bReplayable &= IsReplayableHit(Hit);
+			UMovementUtils::TryMoveToSlideAlongSurface(Params.MovingComps, MoveDelta, 1.0f - Hit.Time, TargetQuat, Hit.Normal, Hit, true, MoveRecord);
+			bReplayable &= IsReplayableHit(Hit);
+		}
+
+		FindFloor(Params, UpdatedComponent->GetComponentLocation(), Floor);
+	}
+
+	if (Floor.IsWalkableFloor())
+	{
+		if (Floor.FloorDist > MaxFloorDist)
+		{
+			FHitResult SnapHit(1.0f);
+			const FVector SnapDelta(0.0, 0.0, MinFloorDist - Floor.FloorDist);
+			// A cached floor corrects its distance by the height difference to the sweep, the snap needs no new sweep
+			UMovementUtils::TrySafeMoveUpdatedComponent(Params.MovingComps, SnapDelta, UpdatedComponent->GetComponentQuat(), true, SnapHit, ETeleportType::None, MoveRecord);
+			bReplayable &= IsReplayableHit(SnapHit);
+		}
+		Velocity.Z = 0.0;
+		bReplayable &= IsStaticPrimitive(Floor.HitResult.GetComponent());
+	}
+
+	if (UMoverBlackboard* SimBlackboard = MoverComponent->GetSimBlackboard_Mutable())
+	{
+		SimBlackboard->Set(CommonBlackboard::LastFloorResult, Floor);
+	}
+
+	// Blocking hits scale the move down, carry that into the velocity but leave the crowd push out of it
+	FVector EndVelocity = bMoving ? MoveRecord.GetRelevantVelocity() - CrowdVelocity : Velocity;
+	if (Floor.IsWalkableFloor())
+	{
+		EndVelocity.Z = 0.0;
+	}
+
+	OutputSyncState.SetTransforms_WorldSpace(UpdatedComponent->GetComponentLocation(), UpdatedComponent->GetComponentRotation(), EndVelocity);
+
+	RecordSnapshot(Params, VortexMover, OutputSyncState, Floor, bReplayable);
+}
+
+void UVortexWalkingMode::RecordSnapshot(const FSimulationTickParams& Params, UVortexMoverComponent* VortexMover, const FMoverDefaultSyncState& SyncState, const FFloorCheckResult& Floor, bool bReplayable) const
+{
+	// Resimulated frames replace what was recorded for them
+	if (FVortexSnapshot* Snapshot = VortexMover ? VortexMover->GetSnapshots().Write(Params.TimeStep.ServerFrame) : nullptr)
+	{
+		Snapshot->SetSyncState(SyncState);
+		Snapshot->SetInput(Params.StartState.InputCmd.InputCollection.FindDataByType<FVortexInputCmd>(), Params.ProposedMove);
+		Snapshot->SetFloor(Floor);
+		Snapshot->bReplayable = bReplayable;
+	}
+}
+
+bool UVortexWalkingMode::ReplaySnapshot(const FSimulationTickParams& Params, const UVortexMoverComponent* VortexMover, const FMoverDefaultSyncState& StartingSyncState, FMoverDefaultSyncState& OutputSyncState) const
+{
+	if (!VortexMover)
+	{
+		return false;
+	}
+
+	// The previous frame's snapshot holds the state this frame started from the first time
+	const int32 Frame = Params.TimeStep.ServerFrame;
+	const FVortexSnapshot* Previous = VortexMover->GetSnapshots().Find(Frame - 1);
+	const FVortexSnapshot* Snapshot = VortexMover->GetSnapshots().Find(Frame);
+	if (!Previous || !Snapshot || !Snapshot->bReplayable
+		|| !Previous->MatchesSyncState(StartingSyncState)
+		|| !Snapshot->MatchesInput(Params.StartState.InputCmd.InputCollection.FindDataByType<FVortexInputCmd>(), Params.ProposedMove))
+	{
+		return false;
+	}
+
+	OutputSyncState = StartingSyncState;
+	Snapshot->GetSyncState(OutputSyncState);
+
+	// The next frame sweeps from the component, put it where the frame ended
+	Params.MovingComps.UpdatedComponent->SetWorldLocationAndRotation(OutputSyncState.GetLocation_WorldSpace(), OutputSyncState.GetOrientation_WorldSpace().Quaternion(), false, nullptr, ETeleportType::None);
+
+	if (UMoverBlackboard* SimBlackboard = Params.MovingComps.MoverComponent->GetSimBlackboard_Mutable())
+	{
+		FFloorCheckResult Floor;
+		Snapshot->GetFloor(OutputSyncState.GetLocation_WorldSpace(), Floor);
+		SimBlackboard->Set(CommonBlackboard::LastFloorResult, Floor);
+	}
+	return true;
+}
+
+bool UVortexWalkingMode::UpdateSleep(const FSimulationTickParams& Params, const FMoverDefaultSyncState& StartingSyncState, const FVector& CrowdVelocity)
+{
+	// Resimulated frames always run in full and leave the sleep state of the live frame alone
+	if (Params.TimeStep.bIsResimulating)
+	{
+		return false;
+	}
+
+	const int32 SleepTicks = VortexMoverCVars::GetSleepTicks();
+	const FVector Location = StartingSyncState.GetLocation_WorldSpace();
+
+	// Layered moves and impulses show up in the proposed move, teleports as a changed location
+	const bool bStill = Params.ProposedMove.LinearVelocity.IsNearlyZero()
+		&& Params.ProposedMove.AngularVelocity.IsNearlyZero()
+		&& StartingSyncState.GetVelocity_WorldSpace().IsNearlyZero()
+		&& CrowdVelocity.IsNearlyZero()
+		&& (!Sleep.bAsleep || Location.Equals(Sleep.Location));
+
+	// The floor the pawn fell asleep on must still be there, unmoved: a moving base wakes it
+	const UPrimitiveComponent* FloorPrimitive = FloorCache.bValid ? FloorCache.Primitive.Get() : nullptr;
+	const bool bStableFloor = FloorPrimitive
+		&& (FloorPrimitive->Mobility == EComponentMobility::Static || FloorPrimitive->GetComponentTransform().Equals(FloorCache.PrimitiveTransform));
+
+	if (SleepTicks <= 0 || !bStill || !bStableFloor || !IsNeutralInput(Params.StartState.InputCmd.InputCollection.FindDataByType<FVortexInputCmd>()))
+	{
+		Sleep = FVortexWalkingSleep();
+		return false;
+	}
+
+	if (!Sleep.bAsleep && ++Sleep.QuietTicks >= SleepTicks)
+	{
+		Sleep.bAsleep = true;
+		Sleep.Location = Location;
+	}
+	return Sleep.bAsleep;
+}
+
+void UVortexWalkingMode::FindFloor(const FSimulationTickParams& Params, const FVector& Location, FFloorCheckResult& OutFloor)
+{
+	// The cache only describes where the pawn is now, resimulated frames use the snapshots or sweep
+	const UVortexWalkingSettings& Tuning = *GetSettings();
+	if (Params.TimeStep.bIsResimulating && RestoreFloor(Params, Tuning, Location, OutFloor))
+	{
+		INC_DWORD_STAT(STAT_VortexFloorSnapshotRestores);
+		return;
+	}
+
+	const bool bUseCache = VortexMoverCVars::IsFloorCacheEnabled() && !Params.TimeStep.bIsResimulating;
+	if (bUseCache && CanReuseFloor(Tuning, Location))
+	{
+		OutFloor = FloorCache.Floor;
+		OutFloor.FloorDist += static_cast<float>(Location.Z - FloorCache.SweepLocation.Z);
+		++FloorCache.ReusedFrames;
+		INC_DWORD_STAT(STAT_VortexFloorCacheHits);
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_VortexFloorSweeps);
+	UFloorQueryUtils::FindFloor(Params.MovingComps.UpdatedComponent.Get(), Params.MovingComps.UpdatedPrimitive.Get(), Tuning.FloorSweepDistance, Tuning.GetMaxWalkSlopeCosine(), Location, OutFloor);
+
+	// Live sweeps refresh the cache even with vortex.walking.FloorCache off, UpdateSleep reads the last swept floor from it
+	if (Params.TimeStep.bIsResimulating)
+	{
+		return;
+	}
+
+	// Only walkable floors are cached, while airborne every tick sweeps
+	const UPrimitiveComponent* Primitive = OutFloor.HitResult.GetComponent();
+	if (!OutFloor.IsWalkableFloor() || !Primitive)
+	{
+		FloorCache.Invalidate();
+		return;
+	}
+
+	FloorCache.Floor = OutFloor;
+	FloorCache.Primitive = Primitive;
+	FloorCache.PrimitiveTransform = Primitive->GetComponentTransform();
+	FloorCache.SweepLocation = Location;
+	FloorCache.ReusedFrames = 0;
+	FloorCache.bValid = true;
+}
+
+bool UVortexWalkingMode::RestoreFloor(const FSimulationTickParams& Params, const UVortexWalkingSettings& Tuning, const FVector& Location, FFloorCheckResult& OutFloor) const
+{
+	const UVortexMoverComponent* VortexMover = Cast<UVortexMoverComponent>(Params.MovingComps.MoverComponent.Get());
+	if (!VortexMover)
+	{
+		return false;
+	}
+
+	// The tick starts where the previous frame ended and ends near where this frame ended the first time
+	const int32 Frame = Params.TimeStep.ServerFrame;
+	for (const int32 RecordedFrame : { Frame - 1, Frame })
+	{
+		const FVortexSnapshot* Snapshot = VortexMover->GetSnapshots().Find(RecordedFrame);
+		if (!Snapshot || FVector::DistSquared(Location, FVector(Snapshot->Location)) > FMath::Square(Tuning.FloorCacheDistance))
+		{
+			continue;
+		}
+
+		// Only static floors are known to be where they were when the frame was recorded
+		if (IsStaticPrimitive(Snapshot->FloorPrimitive.Get()) && Snapshot->GetFloor(Location, OutFloor))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UVortexWalkingMode::CanReuseFloor(const UVortexWalkingSettings& Tuning, const FVector& Location) const
+{
+	if (!FloorCache.bValid || FloorCache.ReusedFrames >= Tuning.FloorCacheMaxFrames)
+	{
+		return false;
+	}
+
+	if (FVector::DistSquared(Location, FloorCache.SweepLocation) > FMath::Square(Tuning.FloorCacheDistance))
+	{
+		return false;
+	}
+
+	const UPrimitiveComponent* Primitive = FloorCache.Primitive.Get();
+	if (!Primitive)
+	{
+		return false;
+	}
+
+	// Static geometry cannot move, anything else must still be where it was swept
+	return Primitive->Mobility == EComponentMobility::Static || Primitive->GetComponentTransform().Equals(FloorCache.PrimitiveTransform);
+}
@@ -0,0 +1,535 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Net/VortexInputNetChannel.h"
+
+#include "HAL/IConsoleManager.h"
+#include "UObject/CoreNet.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverLogChannels.h"
+#include "VortexMoverStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inputs Received"), STAT_VortexInputsReceived, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inputs Recovered"), STAT_VortexInputsRecovered, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inputs Synthesized"), STAT_VortexInputsSynthesized, STATGROUP_VortexMover);
+
+static_assert(FMath::IsPowerOfTwo(FVortexInputNetChannel::HistorySize), "HistorySize must be a power of two");
+static_assert(FVortexInputNetChannel::HistorySize <= (1 << FVortexInputNetChannel::BaselineDistanceBits), "Baseline distance must be able to address the whole history");
+
+namespace
+{
+	constexpr uint8 HistoryMask = FVortexInputNetChannel::HistorySize - 1;
+
+	// Both ends of a stream can live in one process (listen server, PIE), so they are kept apart
+	TMap<uint32, TUniquePtr<FVortexInputNetChannel>> GSendChannels;
+	TMap<uint32, TUniquePtr<FVortexInputNetChannel>> GReceiveChannels;
+	uint32 GNextStreamId = 1;
+
+	FVortexInputNetChannel* FindStreamChannel(const TMap<uint32, TUniquePtr<FVortexInputNetChannel>>& Channels, uint32 StreamId)
+	{
+		const TUniquePtr<FVortexInputNetChannel>* Channel = Channels.Find(StreamId);
+		return Channel ? Channel->Get() : nullptr;
+	}
+
+	// Undecodable commands come from a broken or misbehaving client and can arrive every frame, warn at most once per second
+	void WarnDroppedCommand(const TCHAR* Reason, uint32 StreamId, uint8 Sequence)
+	{
+		static double LastWarningTime = -1.0;
+		static uint32 NumSuppressed = 0;
+
+		const double Now = FPlatformTime::Seconds();
+		if (LastWarningTime >= 0.0 && Now - LastWarningTime < 1.0)
+		{
+			++NumSuppressed;
+			return;
+		}
+
+		UE_LOG(LogVortexMover, Warning, TEXT("Input stream %u: %s for sequence %u, command dropped (%u more dropped since the last warning)"),
+			StreamId, Reason, Sequence, NumSuppressed);
+		LastWarningTime = Now;
+		NumSuppressed = 0;
+	}
+
+	// Older unacknowledged commands to repeat after the one being sent, newest first
+	uint8 GetRedundantSendCount(const FVortexInputNetChannel& Channel, uint8 Sequence)
+	{
+		const int32 Requested = FMath::Clamp(VortexMoverCVars::GetInputRedundancy(), 0, FVortexInputNetChannel::MaxRedundancy);
+
+		uint8 Count = 0;
+		while (Count < Requested)
+		{
+			const uint8 OlderSequence = static_cast<uint8>(Sequence - (Count + 1));
+			const FVortexInputNetChannel::FHistoryEntry& Entry = Channel.SendHistory[OlderSequence & HistoryMask];
+			if (!Entry.bValid || Entry.Sequence != OlderSequence)
+			{
+				break;
+			}
+			if (Channel.bHasAck && !FVortexInputNetChannel::IsSequenceNewer(OlderSequence, Channel.AckedSequence))
+			{
+				break;
+			}
+			++Count;
+		}
+		return Count;
+	}
+
+	void LogInputStats()
+	{
+		for (const TPair<uint32, TUniquePtr<FVortexInputNetChannel>>& Pair : GSendChannels)
+		{
+			const FVortexInputNetChannel::FStats& Stats = Pair.Value->Stats;
+			UE_LOG(LogVortexMover, Display, TEXT("Input stream %u (sending): sent %u, %u as delta (%.2f%%)"),
+				Pair.Key, Stats.Sent, Stats.SentAsDelta, Stats.Sent > 0 ? 100.0 * Stats.SentAsDelta / Stats.Sent : 0.0);
+		}
+
+		for (const TPair<uint32, TUniquePtr<FVortexInputNetChannel>>& Pair : GReceiveChannels)
+		{
+			const FVortexInputNetChannel::FStats& Stats = Pair.Value->Stats;
+			const uint32 Missing = Stats.RecoveredFromRedundancy + Stats.Synthesized;
+			UE_LOG(LogVortexMover, Display, TEXT("Input stream %u (receiving): received %u, missing %u (recovered %u, synthesized %u, %.2f%% of frames synthesized)"),
+				Pair.Value->Id, Stats.Received, Missing, Stats.RecoveredFromRedundancy, Stats.Synthesized,
+				Stats.Received + Missing > 0 ? 100.0 * Stats.Synthesized / (Stats.Received + Missing) : 0.0);
+			if (Stats.Predictions > 0)
+			{
+				UE_LOG(LogVortexMover, Display, TEXT("  starvation policy %d: %u predictions scored, mean move error %.3f, mean angle error %.2f deg"),
+					VortexMoverCVars::GetStarvationPolicy(), Stats.Predictions, Stats.MoveErrorSum / Stats.Predictions, Stats.AngleErrorSum / Stats.Predictions);
+			}
+		}
+	}
+
+	FAutoConsoleCommand CmdVortexInputStats(
+		TEXT("vortex.net.InputStats"),
+		TEXT("Logs per input stream how many commands were sent as deltas, and how many input frames the server received, recovered from redundancy or had to synthesize"),
+		FConsoleCommandDelegate::CreateStatic(&LogInputStats));
+}
+
+const FVortexInputCmd* FVortexInputNetChannel::FindSendBaseline(uint8 Sequence, uint8& OutDistance) const
+{
+	if (!bHasAck || !IsSequenceNewer(Sequence, AckedSequence))
+	{
+		return nullptr;
+	}
+
+	// Too far behind (acks lost or server starved): fall back to full sends until a fresh ack arrives
+	const uint8 Distance = static_cast<uint8>(Sequence - AckedSequence);
+	if (Distance >= HistorySize)
+	{
+		return nullptr;
+	}
+
+	const FHistoryEntry& Entry = SendHistory[AckedSequence & HistoryMask];
+	if (!Entry.bValid || Entry.Sequence != AckedSequence)
+	{
+		return nullptr;
+	}
+
+	OutDistance = Distance;
+	return &Entry.Cmd;
+}
+
+const FVortexInputCmd* FVortexInputNetChannel::FindReceived(uint8 Sequence) const
+{
+	const FHistoryEntry& Entry = ReceiveHistory[Sequence & HistoryMask];
+	return Entry.bValid && Entry.Sequence == Sequence ? &Entry.Cmd : nullptr;
+}
+
+void FVortexInputNetChannel::RecordSent(uint8 Sequence, const FVortexInputCmd& Cmd)
+{
+	FHistoryEntry& Entry = SendHistory[Sequence & HistoryMask];
+	Entry.Cmd = Cmd;
+	Entry.Sequence = Sequence;
+	Entry.bValid = true;
+
+	if (!bHasSent || IsSequenceNewer(Sequence, LastSentSequence))
+	{
+		LastSentSequence = Sequence;
+		bHasSent = true;
+	}
+}
+
+void FVortexInputNetChannel::RecordReceived(uint8 Sequence, const FVortexInputCmd& Cmd)
+{
+	// Arrived so late that its slot already belongs to a newer command
+	if (bHasReceived && static_cast<uint8>(LastReceivedSequence - Sequence) >= HistorySize && !IsSequenceNewer(Sequence, LastReceivedSequence))
+	{
+		return;
+	}
+
+	FHistoryEntry& Entry = ReceiveHistory[Sequence & HistoryMask];
+	Entry.Cmd = Cmd;
+	Entry.Sequence = Sequence;
+	Entry.bValid = true;
+
+	// The real input of the frame that was synthesized last: score how close the guess was
+	if (bHasPrediction && Sequence == LastPredictionSequence)
+	{
+		const double MoveError = (LastPrediction.GetMoveInput() - Cmd.GetMoveInput()).Size();
+		const FRotator AngleDelta = (LastPrediction.ControlRotation - Cmd.ControlRotation).GetNormalized();
+		const double AngleError = FMath::Max(FMath::Abs(AngleDelta.Pitch), FMath::Abs(AngleDelta.Yaw));
+		++Stats.Predictions;
+		Stats.MoveErrorSum += MoveError;
+		Stats.AngleErrorSum += AngleError;
+		CSV_CUSTOM_STAT(VortexMover, InputPredictionMoveError, static_cast<float>(MoveError), ECsvCustomStatOp::Max);
+		bHasPrediction = false;
+	}
+
+	if (!bHasReceived || IsSequenceNewer(Sequence, LastReceivedSequence))
+	{
+		LastReceivedSequence = Sequence;
+		bHasReceived = true;
+		bAckPending = true;
+	}
+}
+
+void FVortexInputNetChannel::OnAckReceived(uint8 Sequence)
+{
+	// Ignore stale or reordered acks, and acks for commands that already fell out of the history
+	if (bHasAck && !IsSequenceNewer(Sequence, AckedSequence))
+	{
+		return;
+	}
+
+	const FHistoryEntry& Entry = SendHistory[Sequence & HistoryMask];
+	if (Entry.bValid && Entry.Sequence == Sequence && bHasSent && !IsSequenceNewer(Sequence, LastSentSequence))
+	{
+		AckedSequence = Sequence;
+		bHasAck = true;
+	}
+}
+
+namespace VortexInputNet
+{
+	uint32 AddReceiveStream()
+	{
+		const uint32 StreamId = GNextStreamId++;
+		TUniquePtr<FVortexInputNetChannel>& Channel = GReceiveChannels.Add(StreamId, MakeUnique<FVortexInputNetChannel>());
+		Channel->Id = StreamId;
+		return StreamId;
+	}
+
+	void RemoveReceiveStream(uint32 StreamId)
+	{
+		GReceiveChannels.Remove(StreamId);
+	}
+
+	FVortexInputNetChannel* FindReceiveChannel(uint32 StreamId)
+	{
+		return FindStreamChannel(GReceiveChannels, StreamId);
+	}
+
+	void RemoveSendStream(uint32 StreamId)
+	{
+		GSendChannels.Remove(StreamId);
+	}
+
+	FVortexInputNetChannel* FindSendChannel(uint32 StreamId)
+	{
+		return FindStreamChannel(GSendChannels, StreamId);
+	}
+
+	bool SerializeSequenced(FVortexInputCmd& Cmd, FArchive& Ar, UPackageMap* Map, EVortexInputWireFormat Format)
+	{
+		uint32 StreamId = Ar.IsSaving() ? Cmd.NetStreamId : 0;
+		Ar.SerializeIntPacked(StreamId);
+
+		uint8 Sequence = 0;
+		uint8 bDelta = 0;
+		uint8 Distance = 0;
+		uint8 FieldMask = EVortexInputField::All;
+
+		if (Ar.IsSaving())
+		{
+			TUniquePtr<FVortexInputNetChannel>& SendChannel = GSendChannels.FindOrAdd(StreamId);
+			if (!SendChannel)
+			{
+				SendChannel = MakeUnique<FVortexInputNetChannel>();
+				SendChannel->Id = StreamId;
+			}
+			FVortexInputNetChannel& Channel = *SendChannel;
+
+			// Cmd is the caller's command, never modify it while saving
+			FVortexInputCmd Upload = Cmd;
+
+			// The producer's input frame, the same for every send NPP makes of this command
+			Sequence = Upload.NetSequence;
+			const FVortexInputCmd* Baseline = VortexMoverCVars::IsInputDeltaEnabled() ? Channel.FindSendBaseline(Sequence, Distance) : nullptr;
+			bDelta = Baseline ? 1 : 0;
+
+			Ar.SerializeBits(&Sequence, FVortexInputNetChannel::SequenceBits);
+			Ar.SerializeBits(&bDelta, 1);
+			if (bDelta)
+			{
+				FieldMask = Upload.GetChangedFields(*Baseline);
+				Ar.SerializeBits(&Distance, FVortexInputNetChannel::BaselineDistanceBits);
+				Ar.SerializeBits(&FieldMask, EVortexInputField::NumBits);
+			}
+
+			Upload.SerializeFields(Ar, FieldMask, Format, Map);
+
+			// Redundancy window: older unacknowledged commands, each coded against the next newer one so held input costs a bit
+			uint8 NumRedundant = GetRedundantSendCount(Channel, Sequence);
+			Ar.SerializeBits(&NumRedundant, FVortexInputNetChannel::RedundancyCountBits);
+
+			const FVortexInputCmd* Newer = &Upload;
+			for (uint8 Index = 1; Index <= NumRedundant; ++Index)
+			{
+				const FVortexInputCmd& OlderEntry = Channel.SendHistory[static_cast<uint8>(Sequence - Index) & HistoryMask].Cmd;
+
+				// Only what goes on the wire decides, a command that decodes the same costs one bit
+				uint8 bSameAsNewer = OlderEntry.HasSameWireValues(*Newer) ? 1 : 0;
+				Ar.SerializeBits(&bSameAsNewer, 1);
+				if (!bSameAsNewer)
+				{
+					FVortexInputCmd Older = OlderEntry;
+					uint8 RedundantMask = Older.GetChangedFields(*Newer);
+					Ar.SerializeBits(&RedundantMask, EVortexInputField::NumBits);
+					Older.SerializeFields(Ar, RedundantMask, Format, Map);
+				}
+				Newer = &OlderEntry;
+			}
+
+			// Every send counts, NPP may send a frame's command more than once
+			++Channel.Stats.Sent;
+			Channel.Stats.SentAsDelta += bDelta;
+			Channel.RecordSent(Sequence, Upload);
+			return true;
+		}
+
+		Ar.SerializeBits(&Sequence, FVortexInputNetChannel::SequenceBits);
+		Ar.SerializeBits(&bDelta, 1);
+
+		// Nothing is made up for a command that can't be decoded: fail the read, the frame then counts as missing and is
+		// filled by the starvation policy. Cmd is left neutral in case the caller uses it anyway.
+		FVortexInputNetChannel* Channel = FindReceiveChannel(StreamId);
+		if (!Channel)
+		{
+			WarnDroppedCommand(TEXT("unknown stream"), StreamId, Sequence);
+			Cmd = FVortexInputCmd();
+			Ar.SetError();
+			return false;
+		}
+
+		if (bDelta)
+		{
+			Ar.SerializeBits(&Distance, FVortexInputNetChannel::BaselineDistanceBits);
+			Ar.SerializeBits(&FieldMask, EVortexInputField::NumBits);
+
+			// The client only deltas against commands the server acknowledged, so this is a broken or spoofed stream
+			const FVortexInputCmd* Baseline = Channel->FindReceived(static_cast<uint8>(Sequence - Distance));
+			if (!Baseline)
+			{
+				WarnDroppedCommand(TEXT("missing delta baseline"), StreamId, Sequence);
+				Cmd = FVortexInputCmd();
+				Ar.SetError();
+				return false;
+			}
+			Cmd = *Baseline;
+		}
+
+		Cmd.SerializeFields(Ar, FieldMask, Format, Map);
+		Cmd.NetChannelId = Channel->Id;
+		Cmd.NetSequence = Sequence;
+
+		uint8 NumRedundant = 0;
+		Ar.SerializeBits(&NumRedundant, FVortexInputNetChannel::RedundancyCountBits);
+
+		// Always consume the whole window so the archive stays aligned, even if the main command can't be trusted
+		FVortexInputCmd Redundant[FVortexInputNetChannel::MaxRedundancy];
+		for (uint8 Index = 1; Index <= NumRedundant; ++Index)
+		{
+			FVortexInputCmd& Older = Redundant[Index - 1];
+			Older = Index == 1 ? Cmd : Redundant[Index - 2];
+			Older.NetSequence = static_cast<uint8>(Sequence - Index);
+
+			uint8 bSameAsNewer = 0;
+			Ar.SerializeBits(&bSameAsNewer, 1);
+			if (!bSameAsNewer)
+			{
+				uint8 RedundantMask = EVortexInputField::None;
+				Ar.SerializeBits(&RedundantMask, EVortexInputField::NumBits);
+				Older.SerializeFields(Ar, RedundantMask, Format, Map);
+			}
+		}
+
+		if (Ar.IsError())
+		{
+			return false;
+		}
+
+		// NPP repeats recent commands in its own sends, count each frame once
+		if (!Channel->FindReceived(Sequence))
+		{
+			++Channel->Stats.Received;
+			INC_DWORD_STAT(STAT_VortexInputsReceived);
+		}
+		Channel->RecordReceived(Sequence, Cmd);
+
+		for (uint8 Index = 0; Index < NumRedundant; ++Index)
+		{
+			if (!Channel->FindReceived(Redundant[Index].NetSequence))
+			{
+				Channel->RecordReceived(Redundant[Index].NetSequence, Redundant[Index]);
+			}
+		}
+		return true;
+	}
+
+	bool TryRecoverNextInput(FVortexInputNetChannel& Channel, FVortexInputCmd& InOutCmd)
+	{
+		// Sequences are input frames, so this is the command the starved frame should have used
+		const uint8 Frame = static_cast<uint8>(InOutCmd.NetSequence + 1);
+		const bool bNewlyStarved = !Channel.bHasStarved || FVortexInputNetChannel::IsSequenceNewer(Frame, Channel.LastStarvedSequence);
+		Channel.LastStarvedSequence = bNewlyStarved ? Frame : Channel.LastStarvedSequence;
+		Channel.bHasStarved = true;
+
+		if (const FVortexInputCmd* Next = Channel.FindReceived(Frame))
+		{
+			InOutCmd = *Next;
+			if (bNewlyStarved)
+			{
+				++Channel.Stats.RecoveredFromRedundancy;
+				INC_DWORD_STAT(STAT_VortexInputsRecovered);
+				CSV_CUSTOM_STAT(VortexMover, InputsRecovered, 1, ECsvCustomStatOp::Accumulate);
+			}
+			return true;
+		}
+
+		if (bNewlyStarved)
+		{
+			++Channel.Stats.Synthesized;
+			INC_DWORD_STAT(STAT_VortexInputsSynthesized);
+			CSV_CUSTOM_STAT(VortexMover, InputsSynthesized, 1, ECsvCustomStatOp::Accumulate);
+		}
+		InOutCmd.NetSequence = Frame;
+		return false;
+	}
+
+	void SynthesizeInput(FVortexInputNetChannel* Channel, FVortexInputCmd& InOutCmd, float DecayAmount)
+	{
+		const EVortexInputStarvationPolicy Policy = static_cast<EVortexInputStarvationPolicy>(
+			FMath::Clamp(VortexMoverCVars::GetStarvationPolicy(), 0, static_cast<int32>(EVortexInputStarvationPolicy::Num) - 1));
+
+		// The starved frame, TryRecoverNextInput moved InOutCmd on to it
+		const uint8 Frame = InOutCmd.NetSequence;
+		bool bPredicted = false;
+
+		if (Policy == EVortexInputStarvationPolicy::HoldLast)
+		{
+			InOutCmd.bJumpJustPressed = false;
+			bPredicted = true;
+		}
+		else if (Policy == EVortexInputStarvationPolicy::Extrapolate && Channel)
+		{
+			// Continue the per frame trend of the two real input frames just before the starved one, never past full stick or
+			// straight up/down. Sequences are input frames, so FramesAhead is how far the guess reaches past real input.
+			const FVortexInputCmd* Latest = nullptr;
+			int32 FramesAhead = 1;
+			for (; FramesAhead <= VortexMoverCVars::GetStarvationExtrapolationFrames() && !Latest; ++FramesAhead)
+			{
+				Latest = Channel->FindReceived(static_cast<uint8>(Frame - FramesAhead));
+			}
+			--FramesAhead;
+
+			const FVortexInputCmd* Previous = Latest ? Channel->FindReceived(static_cast<uint8>(Frame - FramesAhead - 1)) : nullptr;
+			if (Latest && Previous)
+			{
+				const FVector MoveTrend = Latest->GetMoveInput() - Previous->GetMoveInput();
+				InOutCmd.SetMoveInput((Latest->GetMoveInput() + MoveTrend * FramesAhead).GetClampedToMaxSize(1.0));
+
+				const FRotator RotationTrend = (Latest->ControlRotation - Previous->ControlRotation).GetNormalized();
+				FRotator Rotation = Latest->ControlRotation + RotationTrend * FramesAhead;
+				Rotation.Pitch = FMath::Clamp(FRotator::NormalizeAxis(Rotation.Pitch), -90.0, 90.0);
+				InOutCmd.ControlRotation = Rotation.GetNormalized();
+				InOutCmd.OrientationInput = InOutCmd.ControlRotation.Vector().GetSafeNormal();
+
+				InOutCmd.bJumpJustPressed = false;
+				bPredicted = true;
+			}
+		}
+
+		if (!bPredicted)
+		{
+			const float Exponent = FMath::Max(VortexMoverCVars::GetStarvationDecayExponent(), UE_KINDA_SMALL_NUMBER);
+			const float EffectiveDecay = FMath::Clamp(VortexMoverCVars::GetStarvationDecayRate() * FMath::Pow(FMath::Clamp(DecayAmount, 0.0f, 1.0f), Exponent), 0.0f, 1.0f);
+			InOutCmd.SetMoveInput(InOutCmd.GetMoveInput() * (1.0f - EffectiveDecay));
+
+			// Single use inputs
+			InOutCmd.bJumpJustPressed = FMath::IsNearlyZero(DecayAmount) ? InOutCmd.bJumpJustPressed : false;
+		}
+
+		if (Channel)
+		{
+			Channel->LastPrediction = InOutCmd;
+			Channel->LastPredictionSequence = Frame;
+			Channel->bHasPrediction = true;
+		}
+	}
+}
+
+static void CheckInputStream()
+{
+	if (VortexInputWireFormat::GetActiveFormat() == EVortexInputWireFormat::Legacy)
+	{
+		UE_LOG(LogVortexMover, Display, TEXT("Input stream check skipped: the legacy layout (vortex.net.InputWireFormat 0) does not use the input stream"));
+		return;
+	}
+
+	// Both ends of a throwaway stream in this process. Written and read through FVortexInputCmd::NetSerialize with the null
+	// package map Mover's input collection passes, like NPP's upload and the server's decode.
+	const uint32 StreamId = VortexInputNet::AddReceiveStream();
+
+	FVortexInputCmd Sent;
+	Sent.SetMoveInput(FVector(0.71, 0.71, 0.0));
+	Sent.SetControlRotation(FRotator(-12.5, 37.5, 0.0));
+	Sent.bJumpPressed = true;
+	Sent.NetStreamId = StreamId;
+
+	bool bRoundTripped = true;
+	for (uint8 Frame = 0; Frame < 2; ++Frame)
+	{
+		Sent.NetSequence = Frame;
+
+		FNetBitWriter Writer(nullptr, 256);
+		bool bWritten = false;
+		Sent.NetSerialize(Writer, nullptr, bWritten);
+
+		FNetBitReader Reader(nullptr, Writer.GetData(), Writer.GetNumBits());
+		FVortexInputCmd Received;
+		bool bRead = false;
+		Received.NetSerialize(Reader, nullptr, bRead);
+
+		bRoundTripped &= bWritten && bRead && !Reader.IsError() && Reader.GetBitsLeft() == 0 && Received.HasSameWireValues(Sent)
+			&& Received.NetChannelId == StreamId && Received.NetSequence == Frame;
+
+		// What the server's acknowledgement does, the next frame may then be sent as a delta
+		if (FVortexInputNetChannel* SendChannel = VortexInputNet::FindSendChannel(StreamId))
+		{
+			SendChannel->OnAckReceived(Frame);
+		}
+	}
+
+	const FVortexInputNetChannel* SendChannel = VortexInputNet::FindSendChannel(StreamId);
+	const bool bSequenced = SendChannel && SendChannel->Stats.Sent == 2;
+	const bool bDelta = SendChannel && SendChannel->Stats.SentAsDelta == 1;
+	const bool bExpectDelta = VortexMoverCVars::IsInputDeltaEnabled();
+
+	if (bRoundTripped && bSequenced && bDelta == bExpectDelta)
+	{
+		UE_LOG(LogVortexMover, Display, TEXT("Input stream check passed: both commands decoded on the sequenced stream, the second %s"),
+			bDelta ? TEXT("as a delta") : TEXT("in full (vortex.net.InputDelta is off)"));
+	}
+	else
+	{
+		UE_LOG(LogVortexMover, Error, TEXT("Input stream check failed: round trip %s, sequenced stream %s, delta branch %s (expected %s)"),
+			bRoundTripped ? TEXT("ok") : TEXT("mismatch"), bSequenced ? TEXT("used") : TEXT("not used"),
+			bDelta ? TEXT("taken") : TEXT("not taken"), bExpectDelta ? TEXT("taken") : TEXT("not taken"));
+	}
+
+	VortexInputNet::RemoveSendStream(StreamId);
+	VortexInputNet::RemoveReceiveStream(StreamId);
+}
+
+static FAutoConsoleCommand CmdVortexInputStreamCheck(
+	TEXT("vortex.net.InputStreamCheck"),
+	TEXT("Round trips two FVortexInputCmds through NetSerialize the way Mover calls it and checks the upload takes the sequenced delta branch"),
+	FConsoleCommandDelegate::CreateStatic(&CheckInputStream));
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Net/VortexJitterBuffer.h"
+
+#include "VortexMoverCVars.h"
+
+namespace
+{
+	// Weight of a new arrival in the running interval and jitter means
+	constexpr double ArrivalSmoothing = 0.1;
+	// Share of the gap to the arrival clock a new sample's timeline position closes
+	constexpr double ClockFollowRate = 0.1;
+	// Delay growth in seconds per second, fast enough to refill before the next underrun
+	constexpr double DelayGrowRate = 1.0;
+}
+
+void FVortexJitterBuffer::AddSample(double ArrivalTime, const FTransform& Transform)
+{
+	const double MinDelay = VortexMoverCVars::GetSmoothingMinDelay();
+	const double MaxDelay = FMath::Max(VortexMoverCVars::GetSmoothingMaxDelay(), MinDelay);
+	const double Interval = ArrivalTime - LastArrivalTime;
+	LastArrivalTime = ArrivalTime;
+
+	// Proxies only send samples while they change, a gap longer than any delay is the pawn starting to move again
+	double SampleTime = ArrivalTime;
+	if (NumSamples == 0 || Interval > MaxDelay)
+	{
+		Delay = FMath::Max(Delay, MinDelay);
+		bHolding = false;
+	}
+	else
+	{
+		MeanInterval = MeanInterval > 0.0 ? FMath::Lerp(MeanInterval, Interval, ArrivalSmoothing) : Interval;
+		Jitter = FMath::Lerp(Jitter, FMath::Abs(Interval - MeanInterval), ArrivalSmoothing);
+
+		// One mean interval after the previous sample, drifting towards the arrival clock
+		const double PreviousTime = GetSample(0).Time;
+		SampleTime = FMath::Max(FMath::Lerp(PreviousTime + MeanInterval, ArrivalTime, ClockFollowRate), PreviousTime + UE_KINDA_SMALL_NUMBER);
+
+		// Playback had already caught up with the previous sample while this one was on its way
+		if (bHolding)
+		{
+			++NumUnderruns;
+			Delay = FMath::Min(Delay + FMath::Max(MeanInterval, MinDelay), MaxDelay);
+			bHolding = false;
+		}
+	}
+
+	Head = (Head + 1) % Capacity;
+	Samples[Head].Time = SampleTime;
+	Samples[Head].Transform = Transform;
+	NumSamples = FMath::Min(NumSamples + 1, Capacity);
+}
+
+bool FVortexJitterBuffer::Evaluate(double Now, float DeltaTime, FTransform& OutTransform)
+{
+	if (NumSamples == 0)
+	{
+		return false;
+	}
+
+	const double MinDelay = VortexMoverCVars::GetSmoothingMinDelay();
+	const double MaxDelay = FMath::Max(VortexMoverCVars::GetSmoothingMaxDelay(), MinDelay);
+	const double TargetDelay = FMath::Clamp(MeanInterval + VortexMoverCVars::GetSmoothingJitterScale() * Jitter, MinDelay, MaxDelay);
+	Delay = TargetDelay > Delay
+		? FMath::Min(Delay + DelayGrowRate * DeltaTime, TargetDelay)
+		: FMath::Max(Delay - VortexMoverCVars::GetSmoothingShrinkRate() * DeltaTime, TargetDelay);
+
+	// Past the newest sample: hold it, AddSample decides whether that was an underrun or the pawn stopping
+	const double RenderTime = Now - Delay;
+	const FSample& Newest = GetSample(0);
+	if (RenderTime >= Newest.Time)
+	{
+		bHolding = true;
+		OutTransform = Newest.Transform;
+		return true;
+	}
+
+	for (int32 Age = 1; Age < NumSamples; ++Age)
+	{
+		const FSample& From = GetSample(Age);
+		if (From.Time <= RenderTime)
+		{
+			const FSample& To = GetSample(Age - 1);
+			const double Alpha = (RenderTime - From.Time) / (To.Time - From.Time);
+			OutTransform.Blend(From.Transform, To.Transform, static_cast<float>(Alpha));
+			return true;
+		}
+	}
+
+	OutTransform = GetSample(NumSamples - 1).Transform;
+	return true;
+}
+
+void FVortexJitterBuffer::Reset()
+{
+	*this = FVortexJitterBuffer();
+}
+
+void FVortexJitterBuffer::ResetTimeline()
+{
+	Head = INDEX_NONE;
+	NumSamples = 0;
+	bHolding = false;
+}
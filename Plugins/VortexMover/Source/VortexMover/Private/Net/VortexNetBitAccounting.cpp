@@ -0,0 +1,309 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Net/VortexNetBitAccounting.h"
+
+#include "Containers/Ticker.h"
+#include "Engine/NetConnection.h"
+#include "Engine/PackageMapClient.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "UObject/CoreNet.h"
+#include "UObject/ObjectKey.h"
+#include "VortexMoverCVars.h"
+#include "VortexMoverLogChannels.h"
+#include "VortexMoverStats.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Net Bits Sent/s"), STAT_VortexNetBitsSent, STATGROUP_VortexMover);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Net Bits Received/s"), STAT_VortexNetBitsReceived, STATGROUP_VortexMover);
+
+namespace
+{
+	// Indexed by FVortexNetBitField::Index, then 0=received, 1=sent
+	typedef uint64 FFieldBits[FVortexNetBitField::MaxFields][2];
+
+	struct FConnectionBits
+	{
+		FString Name;
+		FFieldBits Window = {};
+		// Bits per second of the last completed window
+		FFieldBits PerSecond = {};
+		FFieldBits Lifetime = {};
+	};
+
+	const FVortexNetBitField* GFields[FVortexNetBitField::MaxFields] = {};
+	int32 GNumFields = 0;
+
+	// Guards GConnections, GWindowStart and GPublishTicker
+	FCriticalSection GConnectionsLock;
+	TMap<TObjectKey<UPackageMap>, FConnectionBits> GConnections;
+	double GWindowStart = 0.0;
+	FTSTicker::FDelegateHandle GPublishTicker;
+
+	// Concrete type of an archive as far as bit positions go. There is no RTTI and IsNetArchive() is also set by archive proxies
+	// and other archives that merely copy the state of a net archive, so the exact class is told by its vtable.
+	enum class EBitArchiveType : uint8
+	{
+		None,
+		Writer,
+		Reader,
+		NetWriter,
+		NetReader
+	};
+
+	const void* GetVTable(const FArchive& Ar)
+	{
+		return *reinterpret_cast<const void* const*>(&Ar);
+	}
+
+	EBitArchiveType GetBitArchiveType(const FArchive& Ar)
+	{
+		static const FBitWriter WriterProbe(0);
+		static const FBitReader ReaderProbe(nullptr, 0);
+		static const FNetBitWriter NetWriterProbe(0);
+		static const FNetBitReader NetReaderProbe(nullptr, nullptr, 0);
+
+		const void* VTable = GetVTable(Ar);
+		if (VTable == GetVTable(NetWriterProbe))
+		{
+			return EBitArchiveType::NetWriter;
+		}
+		if (VTable == GetVTable(NetReaderProbe))
+		{
+			return EBitArchiveType::NetReader;
+		}
+		if (VTable == GetVTable(WriterProbe))
+		{
+			return EBitArchiveType::Writer;
+		}
+		if (VTable == GetVTable(ReaderProbe))
+		{
+			return EBitArchiveType::Reader;
+		}
+		return EBitArchiveType::None;
+	}
+
+	int64 GetBitPosition(const FArchive& Ar, EBitArchiveType Type)
+	{
+		switch (Type)
+		{
+		case EBitArchiveType::Writer:
+		case EBitArchiveType::NetWriter:
+			return static_cast<const FBitWriter&>(Ar).GetNumBits();
+		case EBitArchiveType::Reader:
+		case EBitArchiveType::NetReader:
+			return static_cast<const FBitReader&>(Ar).GetPosBits();
+		default:
+			return INDEX_NONE;
+		}
+	}
+
+	// Mover's data collections serialize their structs with no package map, the net archive underneath still knows its connection's
+	const UPackageMap* GetArchivePackageMap(const FArchive& Ar, EBitArchiveType Type)
+	{
+		switch (Type)
+		{
+		case EBitArchiveType::NetWriter:
+			return static_cast<const FNetBitWriter&>(Ar).PackageMap;
+		case EBitArchiveType::NetReader:
+			return static_cast<const FNetBitReader&>(Ar).PackageMap;
+		default:
+			return nullptr;
+		}
+	}
+
+	FString GetConnectionName(const UPackageMap* Map)
+	{
+		const UPackageMapClient* PackageMapClient = Cast<UPackageMapClient>(Map);
+		const UNetConnection* Connection = PackageMapClient ? PackageMapClient->GetConnection() : nullptr;
+		return Connection ? Connection->LowLevelGetRemoteAddress(true) : GetNameSafe(Map);
+	}
+
+	// Caller holds GConnectionsLock
+	void PublishWindow(double Now)
+	{
+		const double Elapsed = Now - GWindowStart;
+		GWindowStart = Now;
+		if (Elapsed <= 0.0)
+		{
+			return;
+		}
+
+		uint64 FieldTotals[FVortexNetBitField::MaxFields] = {};
+		uint64 Sent = 0;
+		uint64 Received = 0;
+		uint64 MaxConnection = 0;
+
+		for (auto It = GConnections.CreateIterator(); It; ++It)
+		{
+			if (!It.Key().ResolveObjectPtr())
+			{
+				It.RemoveCurrent();
+				continue;
+			}
+
+			FConnectionBits& Bits = It.Value();
+			uint64 ConnectionTotal = 0;
+			for (int32 Index = 0; Index < GNumFields; ++Index)
+			{
+				for (int32 Direction = 0; Direction < 2; ++Direction)
+				{
+					Bits.PerSecond[Index][Direction] = static_cast<uint64>(Bits.Window[Index][Direction] / Elapsed);
+					Bits.Window[Index][Direction] = 0;
+				}
+
+				// Only totals describe a whole struct, the fields are already part of them
+				if (FCString::Strcmp(GFields[Index]->FieldName, TEXT("Total")) == 0)
+				{
+					Received += Bits.PerSecond[Index][0];
+					Sent += Bits.PerSecond[Index][1];
+					ConnectionTotal += Bits.PerSecond[Index][0] + Bits.PerSecond[Index][1];
+				}
+				FieldTotals[Index] += Bits.PerSecond[Index][0] + Bits.PerSecond[Index][1];
+			}
+			MaxConnection = FMath::Max(MaxConnection, ConnectionTotal);
+		}
+
+		SET_DWORD_STAT(STAT_VortexNetBitsSent, Sent);
+		SET_DWORD_STAT(STAT_VortexNetBitsReceived, Received);
+
+#if CSV_PROFILER
+		for (int32 Index = 0; Index < GNumFields; ++Index)
+		{
+			FCsvProfiler::RecordCustomStat(GFields[Index]->CsvStatName, CSV_CATEGORY_INDEX(VortexMover), static_cast<int32>(FieldTotals[Index]), ECsvCustomStatOp::Set);
+		}
+#endif
+		CSV_CUSTOM_STAT(VortexMover, NetBitsMaxConnection, static_cast<int32>(MaxConnection), ECsvCustomStatOp::Set);
+	}
+
+	void LogNetBits(const TArray<FString>& Args)
+	{
+		if (!VortexNetBits::IsEnabled())
+		{
+			UE_LOG(LogVortexMover, Display, TEXT("Net bit accounting is off, enable it with vortex.debug.NetBits 1"));
+		}
+
+		FScopeLock ScopeLock(&GConnectionsLock);
+		for (const TPair<TObjectKey<UPackageMap>, FConnectionBits>& Pair : GConnections)
+		{
+			const FConnectionBits& Bits = Pair.Value;
+			UE_LOG(LogVortexMover, Display, TEXT("Net bits for %s (sent/s, received/s, sent total, received total):"), *Bits.Name);
+			for (int32 Index = 0; Index < GNumFields; ++Index)
+			{
+				UE_LOG(LogVortexMover, Display, TEXT("  %s.%-20s %8llu %8llu %12llu %12llu"), GFields[Index]->StructName, GFields[Index]->FieldName,
+					Bits.PerSecond[Index][1], Bits.PerSecond[Index][0], Bits.Lifetime[Index][1], Bits.Lifetime[Index][0]);
+			}
+		}
+
+		if (Args.Num() > 0 && Args[0] == TEXT("reset"))
+		{
+			GConnections.Reset();
+		}
+	}
+
+	// Publishes on the game thread once per second, so the stats drop to zero when traffic stops instead of freezing
+	bool TickPublish(float DeltaTime)
+	{
+		FScopeLock ScopeLock(&GConnectionsLock);
+		PublishWindow(FPlatformTime::Seconds());
+
+		// The window that just closed covered the switch off, the stats it published are the last ones
+		if (!VortexNetBits::IsEnabled())
+		{
+			GPublishTicker.Reset();
+			return false;
+		}
+		return true;
+	}
+
+	FAutoConsoleCommand CmdVortexNetBitsReport(
+		TEXT("vortex.debug.NetBitsReport"),
+		TEXT("Logs the bits every accounted Vortex net struct field took per connection. Pass 'reset' to clear the counters after logging."),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&LogNetBits));
+}
+
+FVortexNetBitField::FVortexNetBitField(const TCHAR* InStructName, const TCHAR* InFieldName)
+	: StructName(InStructName)
+	, FieldName(InFieldName)
+	, CsvStatName(*FString::Printf(TEXT("NetBits_%s_%s"), InStructName, InFieldName))
+{
+	if (GNumFields < MaxFields)
+	{
+		Index = GNumFields;
+		GFields[GNumFields++] = this;
+	}
+}
+
+FVortexNetBitScope::FVortexNetBitScope(FArchive& InAr, const UPackageMap* InMap, const FVortexNetBitField& InField)
+	: Ar(InAr)
+	, Map(InMap)
+	, Field(InField)
+{
+	if (Field.Index == INDEX_NONE || !Ar.IsNetArchive() || !VortexNetBits::IsEnabled())
+	{
+		return;
+	}
+
+	ArchiveType = static_cast<uint8>(GetBitArchiveType(Ar));
+	if (!Map)
+	{
+		Map = GetArchivePackageMap(Ar, static_cast<EBitArchiveType>(ArchiveType));
+	}
+	if (Map)
+	{
+		StartBits = GetBitPosition(Ar, static_cast<EBitArchiveType>(ArchiveType));
+	}
+}
+
+FVortexNetBitScope::~FVortexNetBitScope()
+{
+	if (StartBits != INDEX_NONE && !Ar.IsError())
+	{
+		VortexNetBits::Record(Map, Field, Ar.IsSaving(), GetBitPosition(Ar, static_cast<EBitArchiveType>(ArchiveType)) - StartBits);
+	}
+}
+
+namespace VortexNetBits
+{
+	bool IsEnabled()
+	{
+		return VortexMoverCVars::IsNetBitAccountingEnabled();
+	}
+
+	void Record(const UPackageMap* Map, const FVortexNetBitField& Field, bool bSending, int64 Bits)
+	{
+		if (!Map || Field.Index == INDEX_NONE || Bits <= 0)
+		{
+			return;
+		}
+
+		FScopeLock ScopeLock(&GConnectionsLock);
+		FConnectionBits* Connection = GConnections.Find(Map);
+		if (!Connection)
+		{
+			Connection = &GConnections.Add(Map);
+			Connection->Name = GetConnectionName(Map);
+		}
+		Connection->Window[Field.Index][bSending ? 1 : 0] += Bits;
+		Connection->Lifetime[Field.Index][bSending ? 1 : 0] += Bits;
+
+		// Publishing runs from the ticker, the first bits counted start it
+		if (!GPublishTicker.IsValid())
+		{
+			GWindowStart = FPlatformTime::Seconds();
+			GPublishTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickPublish), 1.0f);
+		}
+	}
+
+	void Shutdown()
+	{
+		FScopeLock ScopeLock(&GConnectionsLock);
+		if (GPublishTicker.IsValid())
+		{
+			FTSTicker::GetCoreTicker().RemoveTicker(GPublishTicker);
+			GPublishTicker.Reset();
+		}
+	}
+}
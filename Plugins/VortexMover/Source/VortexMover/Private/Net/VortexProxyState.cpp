@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Net/VortexProxyState.h"
+
+#include "Net/VortexNetBitAccounting.h"
+
+namespace
+{
+	const FVortexNetBitField NetBitsTotal(TEXT("VortexProxyState"), TEXT("Total"));
+	const FVortexNetBitField NetBitsServerFrame(TEXT("VortexProxyState"), TEXT("ServerFrame"));
+	const FVortexNetBitField NetBitsLocation(TEXT("VortexProxyState"), TEXT("Location"));
+	const FVortexNetBitField NetBitsOrientation(TEXT("VortexProxyState"), TEXT("Orientation"));
+}
+
+bool FVortexProxyState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	FVortexNetBitScope TotalBits(Ar, Map, NetBitsTotal);
+
+	// Changes to this also need to be reflected in FVortexProxyStateNetSerializer
+	uint32 PackedFrame = static_cast<uint32>(ServerFrame + 1);
+	{
+		FVortexNetBitScope FieldBits(Ar, Map, NetBitsServerFrame);
+		Ar.SerializeIntPacked(PackedFrame);
+	}
+	{
+		FVortexNetBitScope FieldBits(Ar, Map, NetBitsLocation);
+		SerializePackedVector<100, 30>(Location, Ar);
+	}
+	{
+		FVortexNetBitScope FieldBits(Ar, Map, NetBitsOrientation);
+		Orientation.SerializeCompressedShort(Ar);
+	}
+
+	if (Ar.IsLoading())
+	{
+		ServerFrame = static_cast<int32>(PackedFrame) - 1;
+	}
+
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
@@ -0,0 +1,280 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Net/VortexProxyState.h"
+
+#if UE_WITH_IRIS
+
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializationContext.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+
+/**
+ * VortexNetQuantize
+ *
+ * -Fixed point helpers of the Vortex Iris serializers, meant to be shared by serializers of later Vortex state structs
+ * -Positions in hundredths of a cm like SerializePackedVector<100, 30>, rotations as 16 bit axes like SerializeCompressedShort
+ */
+namespace VortexNetQuantize
+{
+	int32 QuantizePosition(double Value)
+	{
+		return static_cast<int32>(FMath::Clamp<int64>(FMath::RoundToInt64(Value * 100.0), MIN_int32 + 1, MAX_int32));
+	}
+
+	double DequantizePosition(int32 Value)
+	{
+		return Value / 100.0;
+	}
+
+	// Small changes, the common case between two states of a moving pawn, take 17 bits instead of 33
+	void WritePositionDelta(UE::Net::FNetBitStreamWriter& Writer, int32 Value, int32 Prev)
+	{
+		const int64 Delta = static_cast<int64>(Value) - Prev;
+		if (Writer.WriteBool(Delta >= MIN_int16 && Delta <= MAX_int16))
+		{
+			Writer.WriteBits(static_cast<uint32>(Delta - MIN_int16), 16);
+		}
+		else
+		{
+			Writer.WriteBits(static_cast<uint32>(Value), 32);
+		}
+	}
+
+	int32 ReadPositionDelta(UE::Net::FNetBitStreamReader& Reader, int32 Prev)
+	{
+		if (Reader.ReadBool())
+		{
+			return static_cast<int32>(Prev + (static_cast<int64>(Reader.ReadBits(16)) + MIN_int16));
+		}
+		return static_cast<int32>(Reader.ReadBits(32));
+	}
+}
+
+namespace UE::Net
+{
+	struct FVortexProxyStateNetSerializerConfig : public FNetSerializerConfig
+	{
+	};
+
+	/**
+	 * FVortexProxyStateNetSerializer
+	 *
+	 * -Iris serializer for FVortexProxyState, the generic replication path is FVortexProxyState::NetSerialize with the same precision
+	 * -Delta: the frame as a short step from the previous one, the location per axis as a short offset, the rotation only if it changed
+	 */
+	struct FVortexProxyStateNetSerializer
+	{
+		static constexpr uint32 Version = 0;
+
+		struct FQuantizedType
+		{
+			// ServerFrame + 1, so INDEX_NONE packs as 0
+			uint32 Frame;
+			int32 Location[3];
+			uint16 Pitch;
+			uint16 Yaw;
+			uint16 Roll;
+		};
+
+		typedef FVortexProxyState SourceType;
+		typedef FVortexProxyStateNetSerializerConfig ConfigType;
+
+		static const ConfigType DefaultConfig;
+
+		static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+		static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+
+		static void SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args);
+		static void DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args);
+
+		static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+		static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+
+		static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+		static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args);
+
+	private:
+		// Frame steps up to this many frames take one byte in a delta
+		static constexpr int32 FrameDeltaBits = 8;
+
+		static void WriteRotation(FNetBitStreamWriter& Writer, const FQuantizedType& Value);
+		static void ReadRotation(FNetBitStreamReader& Reader, FQuantizedType& Value);
+
+		static bool HasSameLocation(const FQuantizedType& A, const FQuantizedType& B) { return A.Location[0] == B.Location[0] && A.Location[1] == B.Location[1] && A.Location[2] == B.Location[2]; }
+		static bool HasSameRotation(const FQuantizedType& A, const FQuantizedType& B) { return A.Pitch == B.Pitch && A.Yaw == B.Yaw && A.Roll == B.Roll; }
+
+		class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+		{
+		public:
+			virtual ~FNetSerializerRegistryDelegates();
+
+		private:
+			virtual void OnPreFreezeNetSerializerRegistry() override;
+		};
+
+		static FVortexProxyStateNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+	};
+
+	UE_NET_IMPLEMENT_SERIALIZER(FVortexProxyStateNetSerializer);
+
+	const FVortexProxyStateNetSerializer::ConfigType FVortexProxyStateNetSerializer::DefaultConfig;
+	FVortexProxyStateNetSerializer::FNetSerializerRegistryDelegates FVortexProxyStateNetSerializer::NetSerializerRegistryDelegates;
+
+	// FVortexProxyState has a NetSerialize, without this Iris would run it through its legacy struct fallback
+	static const FName PropertyNetSerializerRegistry_NAME_VortexProxyState("VortexProxyState");
+	UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_VortexProxyState, FVortexProxyStateNetSerializer);
+
+	FVortexProxyStateNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+	{
+		UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_VortexProxyState);
+	}
+
+	void FVortexProxyStateNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+	{
+		UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_VortexProxyState);
+	}
+
+	void FVortexProxyStateNetSerializer::WriteRotation(FNetBitStreamWriter& Writer, const FQuantizedType& Value)
+	{
+		// Pawns only turn about yaw, pitch and roll are almost always zero
+		Writer.WriteBits(Value.Yaw, 16);
+		if (Writer.WriteBool(Value.Pitch != 0 || Value.Roll != 0))
+		{
+			Writer.WriteBits(Value.Pitch, 16);
+			Writer.WriteBits(Value.Roll, 16);
+		}
+	}
+
+	void FVortexProxyStateNetSerializer::ReadRotation(FNetBitStreamReader& Reader, FQuantizedType& Value)
+	{
+		Value.Yaw = static_cast<uint16>(Reader.ReadBits(16));
+		const bool bTilted = Reader.ReadBool();
+		Value.Pitch = bTilted ? static_cast<uint16>(Reader.ReadBits(16)) : 0;
+		Value.Roll = bTilted ? static_cast<uint16>(Reader.ReadBits(16)) : 0;
+	}
+
+	void FVortexProxyStateNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+	{
+		const FQuantizedType& Value = *reinterpret_cast<const FQuantizedType*>(Args.Source);
+		FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+
+		Writer->WriteBits(Value.Frame, 32);
+		for (const int32 Axis : Value.Location)
+		{
+			Writer->WriteBits(static_cast<uint32>(Axis), 32);
+		}
+		WriteRotation(*Writer, Value);
+	}
+
+	void FVortexProxyStateNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+	{
+		FQuantizedType& Value = *reinterpret_cast<FQuantizedType*>(Args.Target);
+		FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+
+		Value.Frame = Reader->ReadBits(32);
+		for (int32& Axis : Value.Location)
+		{
+			Axis = static_cast<int32>(Reader->ReadBits(32));
+		}
+		ReadRotation(*Reader, Value);
+	}
+
+	void FVortexProxyStateNetSerializer::SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args)
+	{
+		const FQuantizedType& Value = *reinterpret_cast<const FQuantizedType*>(Args.Source);
+		const FQuantizedType& Prev = *reinterpret_cast<const FQuantizedType*>(Args.Prev);
+		FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+
+		const uint32 FrameStep = Value.Frame - Prev.Frame;
+		if (Writer->WriteBool(Value.Frame > Prev.Frame && FrameStep <= (1u << FrameDeltaBits)))
+		{
+			Writer->WriteBits(FrameStep - 1u, FrameDeltaBits);
+		}
+		else
+		{
+			Writer->WriteBits(Value.Frame, 32);
+		}
+
+		if (Writer->WriteBool(!HasSameLocation(Value, Prev)))
+		{
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				VortexNetQuantize::WritePositionDelta(*Writer, Value.Location[Axis], Prev.Location[Axis]);
+			}
+		}
+		if (Writer->WriteBool(!HasSameRotation(Value, Prev)))
+		{
+			WriteRotation(*Writer, Value);
+		}
+	}
+
+	void FVortexProxyStateNetSerializer::DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args)
+	{
+		FQuantizedType& Value = *reinterpret_cast<FQuantizedType*>(Args.Target);
+		const FQuantizedType& Prev = *reinterpret_cast<const FQuantizedType*>(Args.Prev);
+		FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+
+		Value = Prev;
+		Value.Frame = Reader->ReadBool() ? Prev.Frame + Reader->ReadBits(FrameDeltaBits) + 1u : Reader->ReadBits(32);
+
+		if (Reader->ReadBool())
+		{
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				Value.Location[Axis] = VortexNetQuantize::ReadPositionDelta(*Reader, Prev.Location[Axis]);
+			}
+		}
+		if (Reader->ReadBool())
+		{
+			ReadRotation(*Reader, Value);
+		}
+	}
+
+	void FVortexProxyStateNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+	{
+		const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+		FQuantizedType& Target = *reinterpret_cast<FQuantizedType*>(Args.Target);
+
+		Target.Frame = static_cast<uint32>(Source.ServerFrame + 1);
+		Target.Location[0] = VortexNetQuantize::QuantizePosition(Source.Location.X);
+		Target.Location[1] = VortexNetQuantize::QuantizePosition(Source.Location.Y);
+		Target.Location[2] = VortexNetQuantize::QuantizePosition(Source.Location.Z);
+		Target.Pitch = FRotator::CompressAxisToShort(Source.Orientation.Pitch);
+		Target.Yaw = FRotator::CompressAxisToShort(Source.Orientation.Yaw);
+		Target.Roll = FRotator::CompressAxisToShort(Source.Orientation.Roll);
+	}
+
+	void FVortexProxyStateNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+	{
+		const FQuantizedType& Source = *reinterpret_cast<const FQuantizedType*>(Args.Source);
+		SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+
+		Target.ServerFrame = static_cast<int32>(Source.Frame) - 1;
+		Target.Location = FVector(VortexNetQuantize::DequantizePosition(Source.Location[0]), VortexNetQuantize::DequantizePosition(Source.Location[1]), VortexNetQuantize::DequantizePosition(Source.Location[2]));
+		Target.Orientation = FRotator(FRotator::DecompressAxisFromShort(Source.Pitch), FRotator::DecompressAxisFromShort(Source.Yaw), FRotator::DecompressAxisFromShort(Source.Roll));
+	}
+
+	bool FVortexProxyStateNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+	{
+		if (Args.bStateIsQuantized)
+		{
+			const FQuantizedType& Value0 = *reinterpret_cast<const FQuantizedType*>(Args.Source0);
+			const FQuantizedType& Value1 = *reinterpret_cast<const FQuantizedType*>(Args.Source1);
+			return Value0.Frame == Value1.Frame && HasSameLocation(Value0, Value1) && HasSameRotation(Value0, Value1);
+		}
+
+		return *reinterpret_cast<const SourceType*>(Args.Source0) == *reinterpret_cast<const SourceType*>(Args.Source1);
+	}
+
+	bool FVortexProxyStateNetSerializer::Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args)
+	{
+		const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+		return Source.ServerFrame >= INDEX_NONE && !Source.Location.ContainsNaN() && !Source.Orientation.ContainsNaN();
+	}
+}
+
+#endif // UE_WITH_IRIS
@@ -0,0 +1,591 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Replay/VortexInputCapture.h"
+
+#include "Async/MappedFileHandle.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/Paths.h"
+#include "VortexMoverLogChannels.h"
+
+namespace
+{
+	constexpr uint32 DataMagic = 0x4E495856; // "VXIN"
+	constexpr uint32 IndexMagic = 0x58495856; // "VXIX"
+	constexpr uint32 CaptureVersion = 1;
+	constexpr int32 HeaderSize = 16;
+
+	// Record header byte: changed field mask, the three buttons, stream declaration flag
+	constexpr uint8 JumpPressedBit = 1 << 3;
+	constexpr uint8 JumpJustPressedBit = 1 << 4;
+	constexpr uint8 CrouchPressedBit = 1 << 5;
+	constexpr uint8 StreamRecordBit = 1 << 7;
+
+	// Header byte, stream id, sim time and all three vectors
+	constexpr int32 MaxCommandRecordSize = 1 + 2 + 4 + 3 * 3 * sizeof(double);
+	constexpr int32 MaxStreamNameLength = 255;
+
+	template <typename T>
+	void Put(TArray<uint8>& Buffer, const T& Value)
+	{
+		Buffer.Append(reinterpret_cast<const uint8*>(&Value), sizeof(T));
+	}
+
+	void PutVector(TArray<uint8>& Buffer, const FVector& Value)
+	{
+		Put(Buffer, Value.X);
+		Put(Buffer, Value.Y);
+		Put(Buffer, Value.Z);
+	}
+
+	// Bounds checked reads from a mapped file
+	struct FCaptureReader
+	{
+		const uint8* Data = nullptr;
+		int64 Size = 0;
+		int64 Pos = 0;
+		bool bError = false;
+
+		template <typename T>
+		T Get()
+		{
+			T Value{};
+			if (Pos + static_cast<int64>(sizeof(T)) > Size)
+			{
+				bError = true;
+				return Value;
+			}
+			FMemory::Memcpy(&Value, Data + Pos, sizeof(T));
+			Pos += sizeof(T);
+			return Value;
+		}
+
+		FVector GetVector()
+		{
+			const double X = Get<double>();
+			const double Y = Get<double>();
+			const double Z = Get<double>();
+			return FVector(X, Y, Z);
+		}
+	};
+
+	FString GetCaptureBasePath(const FString& Name)
+	{
+		return FPaths::ProjectSavedDir() / TEXT("VortexInput") / Name;
+	}
+
+	// Active capture, swapped under the lock. Cursors only take it when the generation moved.
+	FCriticalSection GCaptureLock;
+	TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> GActiveRecorder;
+	TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> GActiveReplay;
+	std::atomic<uint32> GCaptureGeneration = 0;
+}
+
+FVortexInputRecorder::~FVortexInputRecorder()
+{
+	Close();
+}
+
+TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> FVortexInputRecorder::Create(const FString& BasePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(BasePath));
+
+	TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> Recorder = MakeShared<FVortexInputRecorder, ESPMode::ThreadSafe>();
+	Recorder->DataFile.Reset(PlatformFile.OpenWrite(*(BasePath + TEXT(".vxin"))));
+	Recorder->IndexFile.Reset(PlatformFile.OpenWrite(*(BasePath + TEXT(".vxidx"))));
+	if (!Recorder->DataFile || !Recorder->IndexFile)
+	{
+		Recorder->bClosed = true;
+		return nullptr;
+	}
+
+	for (FBuffer& Buffer : Recorder->Buffers)
+	{
+		Buffer.Data.Reserve(DataBufferSize);
+		Buffer.Index.Reserve(IndexBufferSize);
+	}
+
+	FBuffer& Buffer = Recorder->Buffers[0];
+	Put(Buffer.Data, DataMagic);
+	Put(Buffer.Data, CaptureVersion);
+	Put(Buffer.Data, uint64(0));
+	Put(Buffer.Index, IndexMagic);
+	Put(Buffer.Index, CaptureVersion);
+	Put(Buffer.Index, uint64(0));
+	Recorder->DataOffset = HeaderSize;
+	Recorder->LastFlushTime = FPlatformTime::Seconds();
+	return Recorder;
+}
+
+uint16 FVortexInputRecorder::AddStream(const FString& Name)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	const uint16 StreamId = static_cast<uint16>(LastCmds.Num());
+	LastCmds.AddDefaulted();
+	HasLastCmd.Add(false);
+	CommandsSinceKeyframe.Add(0);
+
+	const FTCHARToUTF8 NameUtf8(*Name);
+	const uint8 NameLength = static_cast<uint8>(FMath::Min(NameUtf8.Length(), MaxStreamNameLength));
+
+	FBuffer* Buffer = &Buffers[ActiveBuffer];
+	if (Buffer->Data.Num() + 4 + NameLength > DataBufferSize || Buffer->Index.Num() + static_cast<int32>(sizeof(FVortexInputCaptureIndexEntry)) > IndexBufferSize)
+	{
+		// Declarations must not be lost, wait for the writer if needed
+		if (!TrySwapBuffers())
+		{
+			FlushTask.Wait();
+			TrySwapBuffers();
+		}
+		Buffer = &Buffers[ActiveBuffer];
+	}
+	if (bClosed)
+	{
+		return StreamId;
+	}
+
+	AppendIndex(*Buffer, FVortexInputCaptureIndexEntry::Stream, StreamId, 0);
+	Put(Buffer->Data, StreamRecordBit);
+	Put(Buffer->Data, StreamId);
+	Put(Buffer->Data, NameLength);
+	Buffer->Data.Append(reinterpret_cast<const uint8*>(NameUtf8.Get()), NameLength);
+	DataOffset += 4 + NameLength;
+	return StreamId;
+}
+
+void FVortexInputRecorder::Append(uint16 StreamId, int32 SimTimeMs, const FVortexInputCmd& Cmd)
+{
+	FScopeLock ScopeLock(&Lock);
+
+	if (bClosed || !LastCmds.IsValidIndex(StreamId))
+	{
+		return;
+	}
+
+	FBuffer* Buffer = &Buffers[ActiveBuffer];
+	const bool bFull = Buffer->Data.Num() + MaxCommandRecordSize > DataBufferSize || Buffer->Index.Num() + static_cast<int32>(sizeof(FVortexInputCaptureIndexEntry)) > IndexBufferSize;
+	if (bFull || FPlatformTime::Seconds() - LastFlushTime > FlushInterval)
+	{
+		if (!TrySwapBuffers() && bFull)
+		{
+			// Next command of this stream must be complete, it can't refer to the one dropped here
+			++NumDropped;
+			HasLastCmd[StreamId] = false;
+			return;
+		}
+		Buffer = &Buffers[ActiveBuffer];
+	}
+
+	// Full records are the seek points, the only ones indexed
+	const bool bKeyframe = !HasLastCmd[StreamId] || CommandsSinceKeyframe[StreamId] >= KeyframeInterval;
+	const uint8 ChangedFields = bKeyframe ? EVortexInputField::All : Cmd.GetChangedFields(LastCmds[StreamId]);
+	const uint8 Header = ChangedFields
+		| (Cmd.bJumpPressed ? JumpPressedBit : 0)
+		| (Cmd.bJumpJustPressed ? JumpJustPressedBit : 0)
+		| (Cmd.bCrouchPressed ? CrouchPressedBit : 0);
+
+	const int32 RecordStart = Buffer->Data.Num();
+	if (bKeyframe)
+	{
+		AppendIndex(*Buffer, FVortexInputCaptureIndexEntry::Command, StreamId, SimTimeMs);
+		CommandsSinceKeyframe[StreamId] = 0;
+	}
+	++CommandsSinceKeyframe[StreamId];
+	Put(Buffer->Data, Header);
+	Put(Buffer->Data, StreamId);
+	Put(Buffer->Data, SimTimeMs);
+	if (ChangedFields & EVortexInputField::MoveInput)
+	{
+		PutVector(Buffer->Data, Cmd.GetMoveInput());
+	}
+	if (ChangedFields & EVortexInputField::OrientationInput)
+	{
+		PutVector(Buffer->Data, Cmd.OrientationInput);
+	}
+	if (ChangedFields & EVortexInputField::ControlRotation)
+	{
+		PutVector(Buffer->Data, Cmd.ControlRotation.Euler());
+	}
+	DataOffset += Buffer->Data.Num() - RecordStart;
+
+	LastCmds[StreamId] = Cmd;
+	HasLastCmd[StreamId] = true;
+	++NumRecorded;
+}
+
+void FVortexInputRecorder::AppendIndex(FBuffer& Buffer, uint8 Kind, uint16 StreamId, int32 SimTimeMs)
+{
+	FVortexInputCaptureIndexEntry Entry;
+	Entry.Offset = DataOffset;
+	Entry.SimTimeMs = SimTimeMs;
+	Entry.StreamId = StreamId;
+	Entry.Kind = Kind;
+	Put(Buffer.Index, Entry);
+}
+
+bool FVortexInputRecorder::TrySwapBuffers()
+{
+	if (bClosed || bFlushInFlight.load(std::memory_order_acquire))
+	{
+		return false;
+	}
+
+	FBuffer& FullBuffer = Buffers[ActiveBuffer];
+	ActiveBuffer ^= 1;
+	LastFlushTime = FPlatformTime::Seconds();
+	if (FullBuffer.Data.IsEmpty() && FullBuffer.Index.IsEmpty())
+	{
+		return true;
+	}
+
+	bFlushInFlight.store(true, std::memory_order_release);
+	FlushTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [this, &FullBuffer]()
+	{
+		WriteBuffer(FullBuffer);
+		bFlushInFlight.store(false, std::memory_order_release);
+	});
+	return true;
+}
+
+void FVortexInputRecorder::WriteBuffer(FBuffer& Buffer)
+{
+	DataFile->Write(Buffer.Data.GetData(), Buffer.Data.Num());
+	IndexFile->Write(Buffer.Index.GetData(), Buffer.Index.Num());
+	DataFile->Flush();
+	IndexFile->Flush();
+
+	// Keeps the allocation for the next swap
+	Buffer.Data.Reset();
+	Buffer.Index.Reset();
+}
+
+void FVortexInputRecorder::Close()
+{
+	{
+		FScopeLock ScopeLock(&Lock);
+		if (bClosed)
+		{
+			return;
+		}
+		bClosed = true;
+	}
+
+	FlushTask.Wait();
+	WriteBuffer(Buffers[ActiveBuffer]);
+	DataFile.Reset();
+	IndexFile.Reset();
+}
+
+TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> FVortexInputReplay::Load(const FString& BasePath)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	TUniquePtr<IMappedFileHandle> IndexHandle(PlatformFile.OpenMapped(*(BasePath + TEXT(".vxidx"))));
+	TUniquePtr<IMappedFileHandle> DataHandle(PlatformFile.OpenMapped(*(BasePath + TEXT(".vxin"))));
+	TUniquePtr<IMappedFileRegion> IndexRegion(IndexHandle ? IndexHandle->MapRegion() : nullptr);
+	TUniquePtr<IMappedFileRegion> DataRegion(DataHandle ? DataHandle->MapRegion() : nullptr);
+	if (!IndexRegion || !DataRegion)
+	{
+		return nullptr;
+	}
+
+	FCaptureReader IndexReader{IndexRegion->GetMappedPtr(), IndexRegion->GetMappedSize()};
+	FCaptureReader DataReader{DataRegion->GetMappedPtr(), DataRegion->GetMappedSize()};
+	if (IndexReader.Get<uint32>() != IndexMagic || IndexReader.Get<uint32>() != CaptureVersion
+		|| DataReader.Get<uint32>() != DataMagic || DataReader.Get<uint32>() != CaptureVersion)
+	{
+		return nullptr;
+	}
+
+	// The index is fixed stride, view it in place. Seek points outside the data or out of order are ignored.
+	const int64 NumEntries = (IndexReader.Size - HeaderSize) / static_cast<int64>(sizeof(FVortexInputCaptureIndexEntry));
+	const FVortexInputCaptureIndexEntry* Entries = reinterpret_cast<const FVortexInputCaptureIndexEntry*>(IndexReader.Data + HeaderSize);
+	TArray<int64> SeekPoints;
+	for (int64 EntryIndex = 0; EntryIndex < NumEntries; ++EntryIndex)
+	{
+		const uint64 Offset = Entries[EntryIndex].Offset;
+		if (Offset >= static_cast<uint64>(DataReader.Size) || Offset < static_cast<uint64>(HeaderSize)
+			|| (!SeekPoints.IsEmpty() && static_cast<int64>(Offset) <= SeekPoints.Last()))
+		{
+			continue;
+		}
+		SeekPoints.Add(static_cast<int64>(Offset));
+	}
+
+	TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> Replay = MakeShared<FVortexInputReplay, ESPMode::ThreadSafe>();
+	// Streams whose previous command is known, commands only carry what changed since then
+	TBitArray<> HasBaseline;
+	int32 NumSkipped = 0;
+	int32 NextSeekPoint = 0;
+
+	DataReader.Pos = HeaderSize;
+	while (DataReader.Pos < DataReader.Size)
+	{
+		const int64 RecordStart = DataReader.Pos;
+		const uint8 Header = DataReader.Get<uint8>();
+		const uint16 StreamId = DataReader.Get<uint16>();
+
+		if (Header & StreamRecordBit)
+		{
+			const uint8 NameLength = DataReader.Get<uint8>();
+			if (StreamId != Replay->Streams.Num() || DataReader.Pos + NameLength > DataReader.Size)
+			{
+				DataReader.bError = true;
+			}
+			else
+			{
+				const FUTF8ToTCHAR Name(reinterpret_cast<const UTF8CHAR*>(DataReader.Data + DataReader.Pos), NameLength);
+				Replay->Streams.AddDefaulted_GetRef().Name = FString(Name.Length(), Name.Get());
+				HasBaseline.Add(false);
+				DataReader.Pos += NameLength;
+			}
+		}
+		else if (!Replay->Streams.IsValidIndex(StreamId))
+		{
+			DataReader.bError = true;
+		}
+		else
+		{
+			FFrame Frame;
+			TArray<FFrame>& Frames = Replay->Streams[StreamId].Frames;
+			if (!Frames.IsEmpty())
+			{
+				Frame.Cmd = Frames.Last().Cmd;
+			}
+			Frame.SimTimeMs = DataReader.Get<int32>();
+
+			if (Header & EVortexInputField::MoveInput)
+			{
+				Frame.Cmd.SetMoveInput(DataReader.GetVector());
+			}
+			if (Header & EVortexInputField::OrientationInput)
+			{
+				Frame.Cmd.OrientationInput = DataReader.GetVector();
+			}
+			if (Header & EVortexInputField::ControlRotation)
+			{
+				Frame.Cmd.ControlRotation = FRotator::MakeFromEuler(DataReader.GetVector());
+			}
+			Frame.Cmd.bJumpPressed = (Header & JumpPressedBit) != 0;
+			Frame.Cmd.bJumpJustPressed = (Header & JumpJustPressedBit) != 0;
+			Frame.Cmd.bCrouchPressed = (Header & CrouchPressedBit) != 0;
+
+			// After a skip a stream waits for its next full record, partial ones would build on lost commands
+			const bool bFull = (Header & EVortexInputField::All) == EVortexInputField::All;
+			if (!DataReader.bError && (bFull || HasBaseline[StreamId]))
+			{
+				Frames.Add(Frame);
+				HasBaseline[StreamId] = true;
+			}
+		}
+
+		if (DataReader.bError)
+		{
+			// Resume at the first seek point past the bad record
+			while (NextSeekPoint < SeekPoints.Num() && SeekPoints[NextSeekPoint] <= RecordStart)
+			{
+				++NextSeekPoint;
+			}
+			++NumSkipped;
+			if (NextSeekPoint >= SeekPoints.Num())
+			{
+				break;
+			}
+			DataReader.Pos = SeekPoints[NextSeekPoint];
+			DataReader.bError = false;
+			HasBaseline.Init(false, HasBaseline.Num());
+		}
+	}
+
+	if (NumSkipped > 0)
+	{
+		UE_LOG(LogVortexMover, Warning, TEXT("Input capture %s is truncated or corrupt, skipped %d damaged regions and replaying what could be read"), *BasePath, NumSkipped);
+	}
+	return Replay;
+}
+
+int32 FVortexInputReplay::ClaimStream(const FString& Name)
+{
+	FScopeLock ScopeLock(&ClaimLock);
+
+	int32 Claimed = Streams.IndexOfByPredicate([&Name](const FStream& Stream) { return !Stream.bClaimed && Stream.Name == Name; });
+	if (Claimed == INDEX_NONE)
+	{
+		Claimed = Streams.IndexOfByPredicate([](const FStream& Stream) { return !Stream.bClaimed; });
+	}
+	if (Claimed != INDEX_NONE)
+	{
+		Streams[Claimed].bClaimed = true;
+	}
+	return Claimed;
+}
+
+namespace VortexInputCapture
+{
+	bool StartRecording(const FString& Name)
+	{
+		const FString BasePath = GetCaptureBasePath(Name);
+		TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> Recorder = FVortexInputRecorder::Create(BasePath);
+		if (!Recorder)
+		{
+			UE_LOG(LogVortexMover, Warning, TEXT("Input capture: could not create %s"), *BasePath);
+			return false;
+		}
+
+		StopRecording();
+		{
+			FScopeLock ScopeLock(&GCaptureLock);
+			GActiveRecorder = Recorder;
+			GCaptureGeneration.fetch_add(1, std::memory_order_release);
+		}
+		UE_LOG(LogVortexMover, Log, TEXT("Input capture: recording to %s"), *BasePath);
+		return true;
+	}
+
+	void StopRecording()
+	{
+		TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> Recorder;
+		{
+			FScopeLock ScopeLock(&GCaptureLock);
+			Recorder = MoveTemp(GActiveRecorder);
+			GCaptureGeneration.fetch_add(1, std::memory_order_release);
+		}
+
+		if (Recorder)
+		{
+			Recorder->Close();
+			UE_LOG(LogVortexMover, Log, TEXT("Input capture: stopped, %llu commands recorded, %llu dropped"), Recorder->GetNumRecorded(), Recorder->GetNumDropped());
+		}
+	}
+
+	bool StartReplay(const FString& Name)
+	{
+		const FString BasePath = GetCaptureBasePath(Name);
+		TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> Replay = FVortexInputReplay::Load(BasePath);
+		if (!Replay)
+		{
+			UE_LOG(LogVortexMover, Warning, TEXT("Input capture: could not load %s"), *BasePath);
+			return false;
+		}
+
+		{
+			FScopeLock ScopeLock(&GCaptureLock);
+			GActiveReplay = Replay;
+			GCaptureGeneration.fetch_add(1, std::memory_order_release);
+		}
+		UE_LOG(LogVortexMover, Log, TEXT("Input capture: replaying %d streams from %s"), Replay->NumStreams(), *BasePath);
+		return true;
+	}
+
+	void StopReplay()
+	{
+		FScopeLock ScopeLock(&GCaptureLock);
+		GActiveReplay.Reset();
+		GCaptureGeneration.fetch_add(1, std::memory_order_release);
+	}
+
+	void Record(FVortexInputRecordCursor& Cursor, const UObject* Owner, int32 SimTimeMs, const FVortexInputCmd& Cmd)
+	{
+		const uint32 Generation = GCaptureGeneration.load(std::memory_order_acquire);
+		if (Cursor.Generation != Generation)
+		{
+			FScopeLock ScopeLock(&GCaptureLock);
+			Cursor.Generation = GCaptureGeneration.load(std::memory_order_relaxed);
+			Cursor.Recorder = GActiveRecorder;
+			if (Cursor.Recorder)
+			{
+				Cursor.StreamId = Cursor.Recorder->AddStream(GetNameSafe(Owner));
+			}
+		}
+
+		if (Cursor.Recorder)
+		{
+			Cursor.Recorder->Append(Cursor.StreamId, SimTimeMs, Cmd);
+		}
+	}
+
+	bool Replay(FVortexInputReplayCursor& Cursor, const UObject* Owner, int32 SimTimeMs, FVortexInputCmd& OutCmd)
+	{
+		const uint32 Generation = GCaptureGeneration.load(std::memory_order_acquire);
+		if (Cursor.Generation != Generation)
+		{
+			FScopeLock ScopeLock(&GCaptureLock);
+			Cursor.Generation = GCaptureGeneration.load(std::memory_order_relaxed);
+			if (Cursor.Replay != GActiveReplay)
+			{
+				Cursor.Replay = GActiveReplay;
+				Cursor.StreamIndex = Cursor.Replay ? Cursor.Replay->ClaimStream(GetNameSafe(Owner)) : INDEX_NONE;
+				Cursor.FrameIndex = 0;
+				Cursor.bStarted = false;
+			}
+		}
+
+		if (!Cursor.Replay || Cursor.StreamIndex == INDEX_NONE)
+		{
+			return false;
+		}
+
+		const TArray<FVortexInputReplay::FFrame>& Frames = Cursor.Replay->GetStream(Cursor.StreamIndex).Frames;
+		if (Frames.IsEmpty())
+		{
+			return false;
+		}
+
+		// Recorded sim times are relative to the session they came from, line the first frame up with now
+		if (!Cursor.bStarted)
+		{
+			Cursor.SimTimeOffsetMs = SimTimeMs - Frames[0].SimTimeMs;
+			Cursor.bStarted = true;
+		}
+
+		const int32 RecordedSimTimeMs = SimTimeMs - Cursor.SimTimeOffsetMs;
+		while (Cursor.FrameIndex + 1 < Frames.Num() && Frames[Cursor.FrameIndex + 1].SimTimeMs <= RecordedSimTimeMs)
+		{
+			++Cursor.FrameIndex;
+		}
+		if (Cursor.FrameIndex + 1 >= Frames.Num() && RecordedSimTimeMs > Frames.Last().SimTimeMs)
+		{
+			return false;
+		}
+
+		OutCmd = Frames[Cursor.FrameIndex].Cmd;
+		return true;
+	}
+}
+
+namespace
+{
+	FAutoConsoleCommand CmdVortexCaptureRecord(
+		TEXT("vortex.capture.Record"),
+		TEXT("Records the input every simulating pawn consumes to Saved/VortexInput/<Name>.vxin/.vxidx\n")
+		TEXT("Usage: vortex.capture.Record [Name]\n"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			VortexInputCapture::StartRecording(Args.IsEmpty() ? FDateTime::Now().ToString() : Args[0]);
+		}));
+
+	FAutoConsoleCommand CmdVortexCaptureReplay(
+		TEXT("vortex.capture.Replay"),
+		TEXT("Feeds a recorded capture back through the input producers, one recorded stream per pawn\n")
+		TEXT("Usage: vortex.capture.Replay <Name>\n"),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (!Args.IsEmpty())
+			{
+				VortexInputCapture::StartReplay(Args[0]);
+			}
+		}));
+
+	FAutoConsoleCommand CmdVortexCaptureStop(
+		TEXT("vortex.capture.Stop"),
+		TEXT("Stops recording and replaying input captures"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			VortexInputCapture::StopRecording();
+			VortexInputCapture::StopReplay();
+		}));
+}
@@ -2,6 +2,8 @@
 
 #include "VortexMover.h"
 
+#include "Net/VortexNetBitAccounting.h"
+
 #define LOCTEXT_NAMESPACE "FVortexMoverModule"
 
 void FVortexMoverModule::StartupModule()
@@ -13,6 +15,7 @@ void FVortexMoverModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+	VortexNetBits::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
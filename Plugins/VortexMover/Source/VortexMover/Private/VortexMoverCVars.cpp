@@ -15,9 +15,508 @@ namespace VortexMoverCVars
 	TEXT(" 2: log only on change\n"),
 	ECVF_Default);
 	
+	static TAutoConsoleVariable<bool> CVarVortexNetBits(
+	TEXT("vortex.debug.NetBits"),
+	false,
+	TEXT("Count the bits every field of the Vortex net structs takes per connection.\n")
+	TEXT("Published as stats and CSV counters every second, see vortex.debug.NetBitsReport.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexInputDelta(
+	TEXT("vortex.net.InputDelta"),
+	true,
+	TEXT("Delta compress client input uploads against the last command acknowledged by the server.\n")
+	TEXT("Falls back to full sends when no recent acknowledgement is available.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexInputAckInterval(
+	TEXT("vortex.net.InputAckInterval"),
+	0.05f,
+	TEXT("Minimum seconds between input acknowledgements sent from the server to the owning client.\n")
+	TEXT("Longer intervals save downstream bandwidth but make delta baselines older.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexInputWireFormat(
+	TEXT("vortex.net.InputWireFormat"),
+	1,
+	TEXT("Wire layout of FVortexInputCmds. Not sent with the commands, the server and all clients must use the same value.\n")
+	TEXT(" 0: legacy (OrientationInput and full ControlRotation, no input stream), readable by builds from before this setting\n")
+	TEXT(" 1: compact (ControlRotation yaw/pitch only, OrientationInput rebuilt on receive, delta compressed input stream) (default)\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexInputRotationBits(
+	TEXT("vortex.net.InputRotationBits"),
+	16,
+	TEXT("Bits per ControlRotation axis in the compact input layout (8-16)\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexInputRedundancy(
+	TEXT("vortex.net.InputRedundancy"),
+	0,
+	TEXT("Number of older, not yet acknowledged input commands repeated in every upload (0-7).\n")
+	TEXT("Lets the server recover input lost with a dropped packet instead of synthesizing it. Repeated held input costs 1 bit.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexStarvationPolicy(
+	TEXT("vortex.net.StarvationPolicy"),
+	0,
+	TEXT("How the server fills in input frames a client has not delivered in time\n")
+	TEXT(" 0: decay the last input's move (default)\n")
+	TEXT(" 1: hold the last input\n")
+	TEXT(" 2: extrapolate move and rotation from the last two received inputs, then decay\n")
+	TEXT("Prediction error against the real input is reported by vortex.net.InputStats.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexStarvationDecayRate(
+	TEXT("vortex.net.StarvationDecayRate"),
+	0.25f,
+	TEXT("Share of MoveInput removed per synthesized input frame at full decay amount (0-1).\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexStarvationDecayExponent(
+	TEXT("vortex.net.StarvationDecayExponent"),
+	1.0f,
+	TEXT("Exponent applied to Mover's decay amount before the decay rate. Above 1 keeps early missing frames closer to the last input.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexStarvationExtrapolationFrames(
+	TEXT("vortex.net.StarvationExtrapolationFrames"),
+	3,
+	TEXT("Consecutive missing input frames the extrapolate policy predicts before falling back to decay.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexReconcileMoveInputTolerance(
+	TEXT("vortex.reconcile.MoveInputTolerance"),
+	0.01f,
+	TEXT("Per axis MoveInput difference tolerated before FVortexInputCmd::ShouldReconcile triggers.\n")
+	TEXT("Default matches the 2 decimal precision MoveInput is replicated with. Buttons are always compared exactly.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexReconcileAngleTolerance(
+	TEXT("vortex.reconcile.AngleTolerance"),
+	0.1f,
+	TEXT("Degrees of ControlRotation/OrientationInput difference tolerated before FVortexInputCmd::ShouldReconcile triggers.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexSubsystemBatchSize(
+	TEXT("vortex.subsystem.BatchSize"),
+	64,
+	TEXT("Number of movers per UVortexMoverSubsystem crowd pass batch.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexSubsystemParallel(
+	TEXT("vortex.subsystem.Parallel"),
+	true,
+	TEXT("Run UVortexMoverSubsystem crowd pass batches on worker threads. 0 runs them on the game thread.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexCrowdEnabled(
+	TEXT("vortex.crowd.Enabled"),
+	false,
+	TEXT("Steer Vortex movers that no client predicts (AI, bots) apart through the subsystem's spatial hash, server authoritative.\n")
+	TEXT("Player pawns are obstacles but never pushed. Pawn collision stays on for all movers.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexCrowdCellSize(
+	TEXT("vortex.crowd.CellSize"),
+	200.0f,
+	TEXT("Edge length (cm) of a crowd spatial hash cell.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexCrowdAvoidanceMargin(
+	TEXT("vortex.crowd.AvoidanceMargin"),
+	40.0f,
+	TEXT("Gap (cm) between two capsules below which movers start steering apart.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexCrowdAvoidanceSpeed(
+	TEXT("vortex.crowd.AvoidanceSpeed"),
+	120.0f,
+	TEXT("Speed (cm/s) of the avoidance push when two capsules are just touching.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexCrowdMaxPushSpeed(
+	TEXT("vortex.crowd.MaxPushSpeed"),
+	600.0f,
+	TEXT("Upper bound (cm/s) of the velocity used to resolve an overlap.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexFloorCache(
+	TEXT("vortex.walking.FloorCache"),
+	true,
+	TEXT("Reuse the last floor found by UVortexWalkingMode while the pawn stays within its motion budget. 0 sweeps every tick, sleep still uses the last swept floor.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexSleepTicks(
+	TEXT("vortex.walking.SleepTicks"),
+	30,
+	TEXT("Still ticks on a stable floor with neutral input before UVortexWalkingMode puts a pawn to sleep. Sleeping pawns skip their movement work and replicate at vortex.netrate.IdleFrequency. 0 never sleeps.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexSnapshotFrames(
+	TEXT("vortex.rollback.SnapshotFrames"),
+	64,
+	TEXT("Frames of compact movement snapshots (sync state, input, floor) kept per pawn for resimulation. Read when a pawn begins play.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexSmoothingMinDelay(
+	TEXT("vortex.smoothing.MinDelay"),
+	0.03f,
+	TEXT("Lowest interpolation delay (seconds) of simulated proxies using the adaptive jitter buffer.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexSmoothingMaxDelay(
+	TEXT("vortex.smoothing.MaxDelay"),
+	0.25f,
+	TEXT("Highest interpolation delay (seconds) of simulated proxies using the adaptive jitter buffer.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexSmoothingJitterScale(
+	TEXT("vortex.smoothing.JitterScale"),
+	2.5f,
+	TEXT("Measured arrival jitter is multiplied by this and added on top of the update interval to get the target delay.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexSmoothingShrinkRate(
+	TEXT("vortex.smoothing.ShrinkRate"),
+	0.05f,
+	TEXT("Seconds of interpolation delay given up per second while the connection is steadier than the delay needs.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexLagCompHistoryFrames(
+	TEXT("vortex.lagcomp.HistoryFrames"),
+	120,
+	TEXT("Sim frames of capsule history the server keeps per pawn for rewinding. 0 disables it. Read when a pawn begins play.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexLagCompMaxSpeed(
+	TEXT("vortex.lagcomp.MaxSpeed"),
+	3000.0f,
+	TEXT("Speed (cm/s) no pawn exceeds, bounds how far from a rewind query's radius a pawn can be now and still match it.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexLODEnabled(
+	TEXT("vortex.lod.Enabled"),
+	false,
+	TEXT("Lower the smoothing quality of simulated proxies by significance (distance to the camera, on screen or not).\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexLODFullMovers(
+	TEXT("vortex.lod.FullMovers"),
+	24,
+	TEXT("Budget: the most significant simulated proxies up to this count keep full quality smoothing.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexLODReducedDistance(
+	TEXT("vortex.lod.ReducedDistance"),
+	6000.0f,
+	TEXT("Proxies outside the full budget but on screen and closer than this (cm) smooth at vortex.lod.ReducedRate, the rest snap.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexLODReducedRate(
+	TEXT("vortex.lod.ReducedRate"),
+	15.0f,
+	TEXT("Smoothing updates per second of reduced tier proxies.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexLODOffscreenScale(
+	TEXT("vortex.lod.OffscreenScale"),
+	4.0f,
+	TEXT("Off screen proxies rank as if they were this many times further away.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexNetRateEnabled(
+	TEXT("vortex.netrate.Enabled"),
+	false,
+	TEXT("Server: adapt each Vortex pawn's NetUpdateFrequency to how much its movement changes, never above the frequency the pawn\n")
+	TEXT("was configured with, which is restored when this is switched off. Also scales GetNetPriority, which Iris does not call.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetRateMaxFrequency(
+	TEXT("vortex.netrate.MaxFrequency"),
+	60.0f,
+	TEXT("Net updates per second of pawns whose velocity changes by vortex.netrate.FullRateAcceleration or more.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetRateMinFrequency(
+	TEXT("vortex.netrate.MinFrequency"),
+	15.0f,
+	TEXT("Net updates per second of moving pawns whose velocity does not change.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetRateIdleFrequency(
+	TEXT("vortex.netrate.IdleFrequency"),
+	2.0f,
+	TEXT("Heartbeat net updates per second of idle pawns. Sleeping walking pawns use it even with vortex.netrate.Enabled off.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarVortexNetRateIdleFrames(
+	TEXT("vortex.netrate.IdleFrames"),
+	30,
+	TEXT("Frames without noticeable movement before a pawn drops to the idle heartbeat.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetRateFullRateAcceleration(
+	TEXT("vortex.netrate.FullRateAcceleration"),
+	3000.0f,
+	TEXT("Velocity change (cm/s^2) at which a pawn replicates at vortex.netrate.MaxFrequency.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetPriorityDistance(
+	TEXT("vortex.netrate.PriorityDistance"),
+	5000.0f,
+	TEXT("Per connection: beyond this distance (cm) from the viewer a pawn's net priority falls off with distance.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetPriorityOutOfViewScale(
+	TEXT("vortex.netrate.OutOfViewScale"),
+	0.5f,
+	TEXT("Per connection: net priority multiplier of pawns behind the viewer.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexNetPriorityIdleScale(
+	TEXT("vortex.netrate.IdleScale"),
+	0.25f,
+	TEXT("Per connection: net priority multiplier of idle pawns.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<bool> CVarVortexInputSubTickAccumulation(
+	TEXT("vortex.input.SubTickAccumulation"),
+	true,
+	TEXT("Integrate timestamped input over each sim tick's window: time weighted move, every press/release edge, summed look delta.\n")
+	TEXT("0 uses only the latest values at the time of the tick.\n"),
+	ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarVortexInputWindowMaxLag(
+	TEXT("vortex.input.WindowMaxLag"),
+	0.25f,
+	TEXT("Seconds the input integration window may trail real time (e.g. after a hitch) before it is resynced to now.\n"),
+	ECVF_Default);
+	
 	int32 IsInputDebugEnabled()
 	{
-		return CVarVortexInputDebug.GetValueOnGameThread();
+		// Read from ProduceInput, which may run on the sim thread
+		return CVarVortexInputDebug.GetValueOnAnyThread();
+	}
+
+	bool IsInputDeltaEnabled()
+	{
+		return CVarVortexInputDelta.GetValueOnAnyThread();
+	}
+
+	float GetInputAckInterval()
+	{
+		return CVarVortexInputAckInterval.GetValueOnAnyThread();
+	}
+
+	int32 GetInputWireFormat()
+	{
+		return CVarVortexInputWireFormat.GetValueOnAnyThread();
+	}
+
+	int32 GetInputRotationBits()
+	{
+		return CVarVortexInputRotationBits.GetValueOnAnyThread();
+	}
+
+	int32 GetInputRedundancy()
+	{
+		return CVarVortexInputRedundancy.GetValueOnAnyThread();
+	}
+
+	int32 GetStarvationPolicy()
+	{
+		return CVarVortexStarvationPolicy.GetValueOnAnyThread();
+	}
+
+	float GetStarvationDecayRate()
+	{
+		return CVarVortexStarvationDecayRate.GetValueOnAnyThread();
+	}
+
+	float GetStarvationDecayExponent()
+	{
+		return CVarVortexStarvationDecayExponent.GetValueOnAnyThread();
+	}
+
+	int32 GetStarvationExtrapolationFrames()
+	{
+		return CVarVortexStarvationExtrapolationFrames.GetValueOnAnyThread();
+	}
+
+	float GetReconcileMoveInputTolerance()
+	{
+		return CVarVortexReconcileMoveInputTolerance.GetValueOnAnyThread();
+	}
+
+	float GetReconcileAngleTolerance()
+	{
+		return CVarVortexReconcileAngleTolerance.GetValueOnAnyThread();
+	}
+
+	int32 GetSubsystemBatchSize()
+	{
+		return CVarVortexSubsystemBatchSize.GetValueOnGameThread();
+	}
+
+	bool IsSubsystemParallelEnabled()
+	{
+		return CVarVortexSubsystemParallel.GetValueOnGameThread();
+	}
+
+	bool IsInputSubTickAccumulationEnabled()
+	{
+		return CVarVortexInputSubTickAccumulation.GetValueOnAnyThread();
+	}
+
+	float GetInputWindowMaxLag()
+	{
+		return CVarVortexInputWindowMaxLag.GetValueOnAnyThread();
+	}
+
+	bool IsCrowdEnabled()
+	{
+		return CVarVortexCrowdEnabled.GetValueOnAnyThread();
+	}
+
+	float GetCrowdCellSize()
+	{
+		return CVarVortexCrowdCellSize.GetValueOnGameThread();
+	}
+
+	float GetCrowdAvoidanceMargin()
+	{
+		return CVarVortexCrowdAvoidanceMargin.GetValueOnAnyThread();
+	}
+
+	float GetCrowdAvoidanceSpeed()
+	{
+		return CVarVortexCrowdAvoidanceSpeed.GetValueOnAnyThread();
+	}
+
+	float GetCrowdMaxPushSpeed()
+	{
+		return CVarVortexCrowdMaxPushSpeed.GetValueOnAnyThread();
+	}
+
+	bool IsFloorCacheEnabled()
+	{
+		return CVarVortexFloorCache.GetValueOnAnyThread();
+	}
+
+	int32 GetSnapshotFrames()
+	{
+		return CVarVortexSnapshotFrames.GetValueOnAnyThread();
+	}
+
+	float GetSmoothingMinDelay()
+	{
+		return CVarVortexSmoothingMinDelay.GetValueOnAnyThread();
+	}
+
+	float GetSmoothingMaxDelay()
+	{
+		return CVarVortexSmoothingMaxDelay.GetValueOnAnyThread();
+	}
+
+	float GetSmoothingJitterScale()
+	{
+		return CVarVortexSmoothingJitterScale.GetValueOnAnyThread();
+	}
+
+	float GetSmoothingShrinkRate()
+	{
+		return CVarVortexSmoothingShrinkRate.GetValueOnAnyThread();
+	}
+
+	int32 GetLagCompHistoryFrames()
+	{
+		return CVarVortexLagCompHistoryFrames.GetValueOnAnyThread();
+	}
+
+	float GetLagCompMaxSpeed()
+	{
+		return CVarVortexLagCompMaxSpeed.GetValueOnAnyThread();
+	}
+
+	bool IsLODEnabled()
+	{
+		return CVarVortexLODEnabled.GetValueOnGameThread();
+	}
+
+	int32 GetLODFullMovers()
+	{
+		return CVarVortexLODFullMovers.GetValueOnGameThread();
+	}
+
+	float GetLODReducedDistance()
+	{
+		return CVarVortexLODReducedDistance.GetValueOnGameThread();
+	}
+
+	float GetLODReducedRate()
+	{
+		return CVarVortexLODReducedRate.GetValueOnGameThread();
+	}
+
+	float GetLODOffscreenScale()
+	{
+		return CVarVortexLODOffscreenScale.GetValueOnGameThread();
+	}
+
+	bool IsNetRateEnabled()
+	{
+		return CVarVortexNetRateEnabled.GetValueOnGameThread();
+	}
+
+	float GetNetRateMaxFrequency()
+	{
+		return CVarVortexNetRateMaxFrequency.GetValueOnGameThread();
+	}
+
+	float GetNetRateMinFrequency()
+	{
+		return CVarVortexNetRateMinFrequency.GetValueOnGameThread();
+	}
+
+	float GetNetRateIdleFrequency()
+	{
+		return CVarVortexNetRateIdleFrequency.GetValueOnGameThread();
+	}
+
+	int32 GetNetRateIdleFrames()
+	{
+		return CVarVortexNetRateIdleFrames.GetValueOnGameThread();
+	}
+
+	float GetNetRateFullRateAcceleration()
+	{
+		return CVarVortexNetRateFullRateAcceleration.GetValueOnGameThread();
+	}
+
+	float GetNetPriorityDistance()
+	{
+		return CVarVortexNetPriorityDistance.GetValueOnGameThread();
+	}
+
+	float GetNetPriorityOutOfViewScale()
+	{
+		return CVarVortexNetPriorityOutOfViewScale.GetValueOnGameThread();
+	}
+
+	float GetNetPriorityIdleScale()
+	{
+		return CVarVortexNetPriorityIdleScale.GetValueOnGameThread();
+	}
+
+	int32 GetSleepTicks()
+	{
+		return CVarVortexSleepTicks.GetValueOnAnyThread();
+	}
+
+	bool IsNetBitAccountingEnabled()
+	{
+		return CVarVortexNetBits.GetValueOnAnyThread();
 	}
 }
 
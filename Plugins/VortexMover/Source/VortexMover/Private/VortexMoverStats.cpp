@@ -0,0 +1,7 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VortexMoverStats.h"
+
+
+CSV_DEFINE_CATEGORY_MODULE(VORTEXMOVER_API, VortexMover, true);
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/LockFreeList.h"
+#include <atomic>
+
+/**
+ * TVortexDataStructPool
+ *
+ * -Recycles the memory of the copies a Vortex Mover data struct's Clone() makes instead of returning it to the allocator
+ * -Mover's history buffers Clone() and release input/state structs every frame, with this the steady state stays off the allocator
+ * -Bounded: Capacity blocks in one arena allocated on first use. Only blocks of that arena go back to the pool, clones made
+ *  while it is empty and structs Mover creates itself (FMemory::Malloc + InitializeStruct) are returned to FMemory on delete
+ * -Requests of any other size (derived structs without their own pool) fall through to FMemory
+ * -Counts pooled and heap allocations, see vortex.debug.DataStructPools
+ * -Thread safety: lock free, any thread
+ */
+template<typename T, int32 Capacity = 1024>
+class TVortexDataStructPool
+{
+public:
+	static void* Allocate(SIZE_T Size)
+	{
+		FPool& Pool = Get();
+		if (Size == sizeof(T))
+		{
+			if (void* Block = Pool.FreeBlocks.Pop())
+			{
+				Pool.NumPoolAllocations.fetch_add(1, std::memory_order_relaxed);
+				return Block;
+			}
+		}
+
+		Pool.NumHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+		return FMemory::Malloc(Size);
+	}
+
+	static void Free(void* Ptr, SIZE_T Size)
+	{
+		FPool& Pool = Get();
+		if (Pool.Owns(Ptr))
+		{
+			Pool.FreeBlocks.Push(Ptr);
+		}
+		else
+		{
+			FMemory::Free(Ptr);
+		}
+	}
+
+	// Allocations served from the arena, and those that went to FMemory because it was empty or the size did not match
+	static uint64 GetNumPoolAllocations() { return Get().NumPoolAllocations.load(std::memory_order_relaxed); }
+	static uint64 GetNumHeapAllocations() { return Get().NumHeapAllocations.load(std::memory_order_relaxed); }
+	static constexpr int32 GetCapacity() { return Capacity; }
+
+private:
+	static constexpr SIZE_T Alignment = FMath::Max<SIZE_T>(alignof(T), 16);
+	static constexpr SIZE_T BlockSize = Align(sizeof(T), Alignment);
+
+	struct FPool
+	{
+		FPool()
+		{
+			Arena = static_cast<uint8*>(FMemory::Malloc(BlockSize * Capacity, Alignment));
+			for (int32 Index = 0; Index < Capacity; ++Index)
+			{
+				FreeBlocks.Push(Arena + BlockSize * Index);
+			}
+		}
+
+		bool Owns(const void* Ptr) const
+		{
+			return Ptr >= Arena && Ptr < Arena + BlockSize * Capacity;
+		}
+
+		// Never freed, pooled structs may still be alive during static destruction
+		uint8* Arena = nullptr;
+		TLockFreePointerListUnordered<void, PLATFORM_CACHE_LINE_SIZE> FreeBlocks;
+		std::atomic<uint64> NumPoolAllocations = 0;
+		std::atomic<uint64> NumHeapAllocations = 0;
+	};
+
+	static FPool& Get()
+	{
+		static FPool Pool;
+		return Pool;
+	}
+};
+
+// Routes the heap allocations a Vortex data struct makes with new (its Clone()) through its TVortexDataStructPool.
+// Place inside the struct body. Placement new stays available for UScriptStruct construction.
+#define VORTEX_POOLED_DATA_STRUCT(StructName) \
+	static void* operator new(SIZE_T Size) { return TVortexDataStructPool<StructName>::Allocate(Size); } \
+	static void operator delete(void* Ptr, SIZE_T Size) { TVortexDataStructPool<StructName>::Free(Ptr, Size); } \
+	static void* operator new(SIZE_T Size, void* Placement) { return Placement; } \
+	static void operator delete(void* Ptr, void* Placement) {}
@@ -4,8 +4,49 @@
 
 #include "CoreMinimal.h"
 #include "MoverTypes.h"
+#include "Core/VortexDataStructPool.h"
 #include "VortexInputDataTypes.generated.h"
 
+// Bitmask of the FVortexInputCmd fields that can be omitted from a delta send. Flags are always sent (1 bit each).
+namespace EVortexInputField
+{
+    enum Type : uint8
+    {
+        None             = 0,
+        MoveInput        = 1 << 0,
+        OrientationInput = 1 << 1,
+        ControlRotation  = 1 << 2,
+
+        All = MoveInput | OrientationInput | ControlRotation
+    };
+
+    constexpr int32 NumBits = 3;
+}
+
+// Wire layout of FVortexInputCmd, picked by vortex.net.InputWireFormat. Not sent with the command: the server and every
+// client have to use the same layout.
+enum class EVortexInputWireFormat : uint8
+{
+    // Packed MoveInput, 48 bit OrientationInput, compressed ControlRotation (pitch, yaw, roll), the flags and nothing else.
+    // Bit for bit what builds from before the wire formats send, so they can still connect. Never uses the input stream.
+    Legacy = 0,
+    // Packed MoveInput, quantized ControlRotation yaw and pitch only. OrientationInput is rebuilt from ControlRotation.
+    // Uploads go through the sequenced input stream (delta, redundancy). Only readable by builds that have it.
+    Compact = 1,
+
+    Num
+};
+
+namespace VortexInputWireFormat
+{
+    constexpr int32 MinRotationBits = 8;
+    constexpr int32 MaxRotationBits = 16;
+
+    // Layout used for sending and receiving, and the rotation precision of outgoing compact commands
+    VORTEXMOVER_API EVortexInputWireFormat GetActiveFormat();
+    VORTEXMOVER_API int32 GetActiveRotationBits();
+}
+
 /**
  * 
  */
@@ -17,6 +58,9 @@ public:
     void SetMoveInput(const FVector& InMoveInput);
     const FVector& GetMoveInput() const { return MoveInput; }
 
+    // Sets ControlRotation at the precision of the active wire format and derives OrientationInput from it
+    void SetControlRotation(const FRotator& InControlRotation);
+
 protected:
     // Movement input in X-Y plane
     FVector MoveInput;
@@ -34,6 +78,18 @@ public:
     // Crouch input
     bool bCrouchPressed;
 
+    // Sim frames this command stands for, more than one once Merge folded older frames into it, weights the next Merge.
+    // Local only: not replicated and not part of equality.
+    uint8 MergedFrames;
+    static constexpr int32 MaxMergedFrames = 8;
+
+    // Sequenced input stream bookkeeping (see FVortexInputNetChannel), not part of equality. NetSequence is the producing
+    // client's input frame and NetStreamId the stream it uploads on, both stamped by UVortexInputProducer. Only commands with
+    // a NetStreamId are sent on the stream. NetChannelId is receiver only: the stream a command was decoded from.
+    uint32 NetStreamId;
+    uint32 NetChannelId;
+    uint8 NetSequence;
+
     FVortexInputCmd()
         : MoveInput(ForceInitToZero)
         , OrientationInput(ForceInitToZero)
@@ -41,6 +97,10 @@ public:
         , bJumpPressed(false)
         , bJumpJustPressed(false)
         , bCrouchPressed(false)
+        , MergedFrames(1)
+        , NetStreamId(0)
+        , NetChannelId(0)
+        , NetSequence(0)
     {
     }
     virtual ~FVortexInputCmd() {}
@@ -57,6 +117,9 @@ public:
 
     bool operator!=(const FVortexInputCmd& Other) const { return !(*this == Other); }
 
+    // Clone(), which Mover's history buffers call every frame, allocates from a bounded pool
+    VORTEX_POOLED_DATA_STRUCT(FVortexInputCmd)
+
     virtual FMoverDataStructBase* Clone() const override;
     virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
     virtual UScriptStruct* GetScriptStruct() const override { return StaticStruct(); }
@@ -66,6 +129,18 @@ public:
     virtual void Interpolate(const FMoverDataStructBase& From, const FMoverDataStructBase& To, float Pct) override;
     virtual void Merge(const FMoverDataStructBase& From) override;
     virtual void Decay(float DecayAmount) override;
+
+    // Returns the EVortexInputField bits whose values differ from Baseline
+    uint8 GetChangedFields(const FVortexInputCmd& Baseline) const;
+
+    // Returns true if every field and flag that goes on the wire matches Other
+    bool HasSameWireValues(const FVortexInputCmd& Other) const;
+
+    // Serialize the fields selected by FieldMask followed by the button flags. Bits are accounted to Map's connection when vortex.debug.NetBits is on.
+    void SerializeFields(FArchive& Ar, uint8 FieldMask, EVortexInputWireFormat Format, const UPackageMap* Map = nullptr);
+
+    // Number of bits a full (non delta) send of this command takes in the given layout
+    int64 GetSerializedBitCount(EVortexInputWireFormat Format) const;
 };
 
 template<>
@@ -3,20 +3,71 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/SpscQueue.h"
+#include "Containers/TripleBuffer.h"
 #include "MoverSimulationTypes.h"
+#include "Replay/VortexInputCapture.h"
 #include "UObject/Object.h"
 #include "VortexInputProducer.generated.h"
 
+class UEnhancedPlayerInput;
+class UInputAction;
 struct FInputActionValue;
+struct FVortexInputCmd;
+
+UENUM()
+enum class EVortexInputSamplingMode : uint8
+{
+	// Input handlers routed from the controller queue timestamped events (default)
+	EventDriven,
+	// ProduceInput reads the held values of the bound input actions from Enhanced Input at the moment Mover asks for input.
+	// Sampled on the game thread only. The routed events are still needed: presses and releases between two samples are
+	// latched from them, and off game thread calls use nothing else.
+	Polled
+};
+
+// Input change recorded on the game thread, applied in order by the consumer (ProduceInput)
+struct FVortexInputEvent
+{
+	enum class EType : uint8
+	{
+		Move,
+		Look,
+		Jump,
+		Crouch,
+		Reset
+	};
+
+	EType Type = EType::Reset;
+	bool bPressed = false;
+	FVector Value = FVector::ZeroVector;
+	// FPlatformTime::Seconds() when the event was recorded
+	double Time = 0.0;
+};
+
+// Game thread snapshot of the owning pawn for ProduceInput calls made off the game thread
+struct FVortexInputOwnerState
+{
+	FRotator ControlRotation = FRotator::ZeroRotator;
+	bool bLocallyControlled = false;
+	// Stream the pawn uploads its input on, 0 when it does not upload (see UVortexMoverComponent::GetInputStreamId)
+	uint32 InputStreamId = 0;
+};
 
 /**
  * UVortexInputProducer
  *
  * -Instanced UObject owned by a Pawn that caches input on the game thread for a MoverComponent to consume on demand
- * -Routed by the Pawn from its controller delegates
+ * -Routed by the Pawn from its controller delegates, held values optionally polled straight from Enhanced Input (see EVortexInputSamplingMode)
  * -Implements IMoverInputProducerInterface to produce input for the MoverComponent
- * -Thread safety: game thread only except ProduceInput which may be called on sim thread
+ * -Thread safety: game thread only except ProduceInput which may be called on sim thread.
+ *  Input handlers only enqueue events into a lock free single producer/single consumer queue, ProduceInput drains it in order,
+ *  so edge triggered inputs (jump) are applied exactly once even when Mover runs on the async physics thread.
+ * -Sub tick accumulation: events are timestamped and integrated over each sim tick's window (time weighted move,
+ *  every press/release edge inside the window), so low sim tick rates don't drop input between ticks.
+ *  Look is not integrated: the controller applies it to the control rotation, which each command carries.
  * -Replication: produce input only for locally controlled pawns
+ * -While an input capture replays (vortex.capture.Replay) the recorded stream replaces live input, see VortexInputCapture
  */
 UCLASS(EditInlineNew, DefaultToInstanced, CollapseCategories, meta = (DisplayName = "Vortex Input Producer"))
 class VORTEXMOVER_API UVortexInputProducer : public UObject, public IMoverInputProducerInterface
@@ -38,11 +89,83 @@ public:
 	// Clear all cached/transient input (e.g., on unpossess)
 	void ResetCachedInput();
 
+	// Game thread: snapshot owner state (control rotation, local control) for ProduceInput calls made off the game thread.
+	// Only locally controlled pawns produce input, the others publish once when they lose control and then nothing.
+	virtual void PublishOwnerState();
+
+	EVortexInputSamplingMode GetSamplingMode() const { return SamplingMode; }
+
+	// Actions read in Polled mode, set by the Pawn in addition to routing its controller delegates
+	void SetPolledInputActions(const UInputAction* InMoveAction, const UInputAction* InLookAction, const UInputAction* InJumpAction, const UInputAction* InCrouchAction);
+
+protected:
+	// While an input capture is replaying, replaces Cmd with this pawn's recorded input and returns true
+	bool ProduceReplayedInput(int32 SimTimeMs, FVortexInputCmd& Cmd);
+
+	// Consumer: drop queued events unread, for producers that do not build input from them
+	void DiscardPendingEvents();
+
+	// Consumer: numbers a produced command with the next input frame and tags it with the owner's upload stream,
+	// the sequence and stream it is sent on
+	void StampInputFrame(FVortexInputCmd& Cmd);
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	EVortexInputSamplingMode SamplingMode = EVortexInputSamplingMode::EventDriven;
+
 private:
+	UPROPERTY(Transient)
+	TObjectPtr<const UInputAction> PolledMoveAction;
+	UPROPERTY(Transient)
+	TObjectPtr<const UInputAction> PolledLookAction;
+	UPROPERTY(Transient)
+	TObjectPtr<const UInputAction> PolledJumpAction;
+	UPROPERTY(Transient)
+	TObjectPtr<const UInputAction> PolledCrouchAction;
+
+	// Game thread: read the polled actions and apply them as if they were events recorded now. Runs after the queued events
+	// were integrated, so a press and release latched from them still shows in the window.
+	void SamplePolledInput(const UEnhancedPlayerInput& PlayerInput);
+
+	FVortexInputReplayCursor ReplayCursor;
+
 	TWeakObjectPtr<APawn> OwnerPawn;
+
+	// Game thread -> consumer handoff
+	TSpscQueue<FVortexInputEvent> PendingEvents;
+	void EnqueueEvent(FVortexInputEvent& Event);
+
+	// Latest owner snapshot, overwritten rather than queued so it costs nothing when nobody consumes it
+	TTripleBuffer<FVortexInputOwnerState> OwnerStateBuffer;
+	// Game thread side: what was last published
+	bool bPublishedLocallyControlled = false;
+
+	// Consumer: integrate queued events up to WindowEnd into the Window* values, later events wait for the next tick
+	void IntegrateInputWindow(double WindowEnd, bool bTimeWeighted);
+	void ApplyEvent(const FVortexInputEvent& Event);
+	void ResetConsumerState();
+
+	// Consumer side events already dequeued but recorded after the current window
+	TArray<FVortexInputEvent> DeferredEvents;
+
+	// Input frame of the next produced command, see FVortexInputCmd::NetSequence
+	uint8 NextInputFrame = 0;
+
+	// Sim window mapped onto real time
+	double WindowStart = 0.0;
+	int32 PrevSimTimeMs = 0;
+	bool bHasWindow = false;
+
+	// Integrated over the last window
+	FVector WindowMove = FVector::ZeroVector;
+	bool bWindowJumpHeld = false;
+	bool bWindowCrouchHeld = false;
 	
-	// Cached state (game thread)
+	// Cached state (consumer side, only touched by ProduceInput)
+	FRotator OwnerControlRotation = FRotator::ZeroRotator;
+	bool bOwnerLocallyControlled = false;
+	uint32 OwnerInputStreamId = 0;
 	FVector CachedMove = FVector::ZeroVector;
+	// Latest look axis value, for debug logging only
 	FRotator CachedLook = FRotator::ZeroRotator;
 	bool bJumpPressed = false;
 	bool bJumpJustPressed = false;
@@ -55,7 +178,7 @@ private:
 	bool bPrevCrouchPressed = false;
 
 	// Debug
-	void LogPerFrame() const;
+	void LogPerFrame(const FVortexInputCmd& Cmd) const;
 	void LogOnChange();
 };
 
@@ -4,8 +4,35 @@
 
 #include "CoreMinimal.h"
 #include "Mover/Public/MoverComponent.h"
+#include "Containers/TripleBuffer.h"
+#include "Core/VortexMoverHistory.h"
+#include "Core/VortexSnapshotBuffer.h"
+#include "Net/VortexJitterBuffer.h"
+#include "Net/VortexProxyState.h"
+#include "Replay/VortexInputCapture.h"
+#include <atomic>
 #include "VortexMoverComponent.generated.h"
 
+UENUM()
+enum class EVortexProxySmoothingMode : uint8
+{
+	// Simulated proxies use the component's SmoothingMode
+	Mover,
+	// Simulated proxies show their primary visual component through an FVortexJitterBuffer
+	AdaptiveJitterBuffer
+};
+
+// Simulated proxy smoothing quality, assigned by UVortexMoverSubsystem from significance
+UENUM()
+enum class EVortexMoverLOD : uint8
+{
+	Full,
+	// Smoothing updated at vortex.lod.ReducedRate
+	Reduced,
+	// No smoothing, the visual follows the received transform
+	Snap
+};
+
 /**
  * 
  */
@@ -17,5 +44,129 @@ class VORTEXMOVER_API UVortexMoverComponent : public UMoverComponent
 public:
 	UVortexMoverComponent();
 
+	virtual void PostLoad() override;
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Slot in UVortexMoverSubsystem's hot state, INDEX_NONE while not registered
+	int32 GetHotStateIndex() const { return HotStateIndex; }
+	void SetHotStateIndex(int32 InIndex) { HotStateIndex = InIndex; }
+
+	// Server assigned id of the stream the owning client uploads its input on (see FVortexInputNetChannel), 0 until it replicated
+	uint32 GetInputStreamId() const { return InputStreamId; }
+
+	// Server: acknowledge the latest input received on this pawn's stream. Called by UVortexMoverSubsystem.
+	void SendInputAck();
+
+	// Velocity pushing the mover out of overlapping neighbours. Set on the game thread by UVortexMoverSubsystem's crowd pass,
+	// read by UVortexWalkingMode from the sim (possibly the async physics thread), which sees the latest value set.
+	void SetCrowdVelocity(const FVector& InCrowdVelocity);
+	const FVector& ConsumeCrowdVelocity();
+
+	// Compact per frame history of the simulation, recorded by Vortex movement modes and read back during resimulation
+	FVortexSnapshotBuffer& GetSnapshots() { return Snapshots; }
+	const FVortexSnapshotBuffer& GetSnapshots() const { return Snapshots; }
+
+	// Sim: UVortexWalkingMode marks every live tick the pawn sleeps through. A tick that is not marked, in any mode, wakes the pawn.
+	void MarkSleepingTick() { bSleepingTick = true; }
+	// Game thread: true if the last live sim tick was a sleeping one
+	bool IsSimAsleep() const { return bSimAsleep.load(std::memory_order_relaxed); }
+
+	// Server, game thread: picks the owner's NetUpdateFrequency from idle time and velocity change, at most the configured one.
+	// A sleeping pawn drops to the idle heartbeat even with vortex.netrate.Enabled off, and forces an update when it wakes.
+	// Restores the configured frequency once neither applies. Called by UVortexMoverSubsystem.
+	void UpdateNetUpdateFrequency(const FVector& Velocity, uint16 QuietFrames, float DeltaTime);
+
+	// Server: multiplier for the owner's GetNetPriority towards one viewer, from distance, view direction and idleness.
+	// Only the generic replication system calls GetNetPriority, Iris prioritizes without it.
+	float GetNetPriorityScale(const FVector& ViewPos, const FVector& ViewDir) const;
+
+	// Server: where the capsule was over the last vortex.lagcomp.HistoryFrames sim frames, recorded after each simulation tick
+	FVortexMoverHistory& GetHistory() { return History; }
+	const FVortexMoverHistory& GetHistory() const { return History; }
+
+	// True if simulated proxies are smoothed by the jitter buffer, the component then replicates an FVortexProxyState to them
+	bool UsesProxyJitterBuffer() const { return ProxySmoothingMode == EVortexProxySmoothingMode::AdaptiveJitterBuffer; }
+
+	// Server, game thread: restamps the replicated FVortexProxyState if the pawn moved since it was last written. Called by UVortexMoverSubsystem.
+	void UpdateProxyState();
+	const FVortexProxyState& GetProxyState() const { return ProxyState; }
+
+	// Simulated proxy, game thread: plays back the jitter buffer onto the visual component. Called by UVortexMoverSubsystem.
+	void UpdateProxySmoothing(float DeltaTime);
+
+	EVortexMoverLOD GetProxyLOD() const { return ProxyLOD; }
+	void SetProxyLOD(EVortexMoverLOD InLOD);
+
+	// Current interpolation delay (seconds) and underruns of the proxy jitter buffer
+	double GetProxyInterpolationDelay() const { return ProxyJitterBuffer.GetDelay(); }
+	uint32 GetProxyUnderruns() const { return ProxyJitterBuffer.GetNumUnderruns(); }
+
+	// Time spent in movement simulation ticks since the last call, then restarts the count. Used by load tests.
+	void ConsumeSimulationCost(uint64& OutCycles, uint32& OutTicks);
+
 protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Vortex")
+	EVortexProxySmoothingMode ProxySmoothingMode = EVortexProxySmoothingMode::Mover;
+
+	// Server -> owning client: the server holds the input command with this stream sequence, it may be used as a delta baseline
+	UFUNCTION(Client, Unreliable)
+	void ClientAckInputSequence(uint8 Sequence);
+
+private:
+	// Measures simulation cost, records the consumed input while an input capture is active and the lag compensation history
+	UFUNCTION()
+	void HandlePreSimulationTick(const FMoverTimeStep& TimeStep, const FMoverInputCmdContext& InputCmd);
+	UFUNCTION()
+	void HandlePostSimulationTick(const FMoverTimeStep& TimeStep);
+	// Simulated proxy: feeds each received FVortexProxyState to the jitter buffer
+	UFUNCTION()
+	void OnRep_ProxyState();
+
+	int32 HotStateIndex = INDEX_NONE;
+
+	UPROPERTY(Replicated)
+	uint32 InputStreamId = 0;
+
+	// Authority transform for simulated proxies using the jitter buffer, only sent while the pawn moves
+	UPROPERTY(ReplicatedUsing = OnRep_ProxyState)
+	FVortexProxyState ProxyState;
+
+	// Game thread -> sim handoff of the crowd velocity, and the last value the sim read
+	TTripleBuffer<FVector> CrowdVelocityBuffer;
+	FVector SimCrowdVelocity = FVector::ZeroVector;
+	bool bCrowdVelocitySet = false;
+
+	// Simulation cost, the sim may tick off the game thread
+	uint64 SimTickStartCycles = 0;
+	std::atomic<uint64> SimulationCycles = 0;
+	std::atomic<uint32> SimulationTicks = 0;
+	// Server frame of the last live sim tick, stamped into ProxyState
+	std::atomic<int32> LastSimFrame = INDEX_NONE;
+	// Sleep of the current sim tick, published to the game thread after it (the sim may tick off the game thread)
+	bool bSleepingTick = false;
+	std::atomic<bool> bSimAsleep = false;
+
+	FVortexInputRecordCursor InputRecordCursor;
+	FVortexSnapshotBuffer Snapshots;
+	FVortexMoverHistory History;
+
+	// Adaptive net update frequency: velocity at the previous update and the smoothed 0-1 rate of change
+	FVector NetRateVelocity = FVector::ZeroVector;
+	float NetRateChange = 0.0f;
+	bool bNetIdle = false;
+	// Owner's NetUpdateFrequency before the adaptive rate took over
+	float ConfiguredNetUpdateFrequency = 0.0f;
+	bool bNetRateActive = false;
+
+	EVortexMoverLOD ProxyLOD = EVortexMoverLOD::Full;
+	// SmoothingMode as configured, restored when a proxy leaves the snap tier
+	EMoverSmoothingMode ConfiguredSmoothingMode = EMoverSmoothingMode::None;
+	// Time since the last reduced tier smoothing update
+	float ProxyLODAccumulatedTime = 0.0f;
+
+	FVortexJitterBuffer ProxyJitterBuffer;
+	// The visual component's transform relative to the updated component
+	FTransform VisualRelativeTransform;
 };
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FVortexMoverHistory
+ *
+ * -Server side record of where a pawn's capsule was, for rewinding it to a client's view time (lag compensation)
+ * -Fixed capacity ring of float transforms and velocities in time order, allocated once by Init
+ * -Evaluate finds the bracketing entries by binary search and interpolates between them, no allocation
+ * -Times are server sim time in seconds (FMoverTimeStep), recorded after each simulated frame
+ * -Thread safety: recorded from the sim (possibly the async physics thread), evaluated on the game thread, guarded by a lock
+ */
+class VORTEXMOVER_API FVortexMoverHistory
+{
+public:
+	void Init(int32 InCapacity);
+	bool IsEnabled() const { return !Entries.IsEmpty(); }
+
+	// Time must not go backwards, an entry for the same time replaces the previous one
+	void Record(double Time, const FVector& Location, const FQuat& Rotation, const FVector& Velocity);
+
+	// Pose at Time, clamped to the recorded range. False if nothing was recorded.
+	bool Evaluate(double Time, FVector& OutLocation, FQuat& OutRotation, FVector& OutVelocity) const;
+
+	double GetOldestTime() const;
+	double GetNewestTime() const;
+
+private:
+	struct FEntry
+	{
+		double Time = 0.0;
+		FVector3f Location = FVector3f::ZeroVector;
+		FVector3f Velocity = FVector3f::ZeroVector;
+		FQuat4f Rotation = FQuat4f::Identity;
+	};
+
+	// Index 0 is the oldest entry
+	const FEntry& Get(int32 Index) const { return Entries[(First + Index) % Entries.Num()]; }
+
+	TArray<FEntry> Entries;
+	int32 First = 0;
+	int32 Num = 0;
+	mutable FCriticalSection Lock;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FVortexMoverSpatialHash
+ *
+ * -Uniform 2D grid (XY) of mover slots, used for pawn vs pawn queries instead of physics scene queries
+ * -Incremental: a mover is only moved between buckets when it crosses a cell border, buckets keep their allocation
+ * -Stores hot state indices (see FVortexMoverHotState), the owner keeps them valid when slots are swapped
+ * -Thread safety: mutate on one thread, concurrent ForEachNearby calls are fine while nothing mutates
+ */
+class VORTEXMOVER_API FVortexMoverSpatialHash
+{
+public:
+	// Clears all buckets if the cell size changed, returns true if that happened and everything must be re-added
+	bool SetCellSize(float InCellSize);
+	float GetCellSize() const { return CellSize; }
+
+	uint64 GetCellKey(const FVector& Location) const;
+
+	void Add(int32 Index, uint64 CellKey);
+	void Remove(int32 Index, uint64 CellKey);
+	void Move(int32 Index, uint64 OldCellKey, uint64 NewCellKey);
+	// The slot stored under OldIndex is now stored under NewIndex
+	void Reindex(int32 OldIndex, int32 NewIndex, uint64 CellKey);
+	void Reset();
+
+	// Calls Func(Index) for every slot in cells overlapping the XY square of half size Radius around Location
+	template <typename FuncType>
+	void ForEachNearby(const FVector& Location, float Radius, FuncType&& Func) const
+	{
+		const int32 MinX = FMath::FloorToInt32((Location.X - Radius) / CellSize);
+		const int32 MaxX = FMath::FloorToInt32((Location.X + Radius) / CellSize);
+		const int32 MinY = FMath::FloorToInt32((Location.Y - Radius) / CellSize);
+		const int32 MaxY = FMath::FloorToInt32((Location.Y + Radius) / CellSize);
+		for (int32 X = MinX; X <= MaxX; ++X)
+		{
+			for (int32 Y = MinY; Y <= MaxY; ++Y)
+			{
+				if (const TArray<int32>* Bucket = Cells.Find(MakeKey(X, Y)))
+				{
+					for (const int32 Index : *Bucket)
+					{
+						Func(Index);
+					}
+				}
+			}
+		}
+	}
+
+private:
+	static uint64 MakeKey(int32 X, int32 Y) { return (static_cast<uint64>(static_cast<uint32>(X)) << 32) | static_cast<uint32>(Y); }
+
+	float CellSize = 200.0f;
+	TMap<uint64, TArray<int32>> Cells;
+};
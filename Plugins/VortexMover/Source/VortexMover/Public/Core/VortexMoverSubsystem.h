@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/VortexMoverSpatialHash.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VortexMoverSubsystem.generated.h"
+
+class UVortexMoverComponent;
+
+/**
+ * FVortexMoverHotState
+ *
+ * -Per mover state the subsystem touches every frame, stored as parallel arrays so each pass only streams the data it reads
+ * -Index i of every array belongs to the same mover, see UVortexMoverComponent::GetHotStateIndex
+ */
+struct VORTEXMOVER_API FVortexMoverHotState
+{
+	TArray<FVector> Locations;
+	TArray<FVector> Velocities;
+	// Consecutive frames without noticeable movement, saturates
+	TArray<uint16> QuietFrames;
+	// ENetRole of the owning actor, and its remote role (ROLE_AutonomousProxy if a client controls it)
+	TArray<uint8> Roles;
+	TArray<uint8> RemoteRoles;
+	// Collision capsule of the updated component, bounds based if it is not a capsule
+	TArray<float> Radii;
+	TArray<float> HalfHeights;
+	// Crowd spatial hash cell the mover is filed under
+	TArray<uint64> CellKeys;
+	// Velocity pushing the mover out of and away from nearby movers, zero while the crowd pass is off and for non crowd members
+	TArray<FVector> CrowdVelocities;
+	// Simulated proxies: squared camera distance, scaled up while off screen (lower is more significant), and the resulting EVortexMoverLOD
+	TArray<float> Significances;
+	TArray<uint8> LODs;
+
+	int32 Num() const { return Locations.Num(); }
+	int32 Add();
+	void RemoveAtSwap(int32 Index);
+
+	// True for the movers the crowd pass pushes: authority movers that no client predicts
+	bool IsCrowdMember(int32 Index) const;
+};
+
+// A mover's capsule as it was at the time of a UVortexMoverSubsystem::RewindMovers query
+struct FVortexRewoundMover
+{
+	UVortexMoverComponent* Mover = nullptr;
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Velocity = FVector::ZeroVector;
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+};
+
+/**
+ * UVortexMoverSubsystem
+ *
+ * -Gathers every UVortexMoverComponent in the world once per frame instead of ticking them one at a time
+ * -Frame: gather the movers into the hot state and write results back on the game thread, one pass each. Only the crowd
+ *  pass runs in batches on worker threads (ParallelFor).
+ * -Crowd pass (vortex.crowd.Enabled), server authoritative: movers are filed in a spatial hash and movers no client predicts
+ *  (AI, bots) are steered apart from nearby movers before they collide. Player pawns are obstacles but never pushed, a push
+ *  their client can't predict would be corrected. Pawn collision stays on for everyone.
+ * -Movement simulation itself stays with Mover's backend, this owns the Vortex side of each mover's frame
+ * -Client (vortex.lod.Enabled, off by default): ranks simulated proxies by significance and assigns their smoothing EVortexMoverLOD, vortex.lod.FullMovers get full quality
+ * -Server: RewindMovers answers lag compensation queries from each mover's FVortexMoverHistory
+ * -Server (vortex.netrate.Enabled, off by default): adapts each mover's NetUpdateFrequency to its movement, idle movers drop to a heartbeat
+ * -Thread safety: everything but the crowd batches on game thread, batches only write their own slice of the hot state
+ */
+UCLASS()
+class VORTEXMOVER_API UVortexMoverSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void RegisterMover(UVortexMoverComponent* Mover);
+	void UnregisterMover(UVortexMoverComponent* Mover);
+
+	const TArray<TObjectPtr<UVortexMoverComponent>>& GetMovers() const { return Movers; }
+	const FVortexMoverHotState& GetHotState() const { return HotState; }
+	const FVortexMoverSpatialHash& GetSpatialHash() const { return SpatialHash; }
+
+	// Server: every mover whose capsule center was within Radius of Origin at Time (sim time seconds), rewound to that time.
+	// Fills at most OutMovers.Num() entries and returns how many, allocates nothing.
+	int32 RewindMovers(const FVector& Origin, float Radius, double Time, TArrayView<FVortexRewoundMover> OutMovers) const;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	// Game thread: refresh the hot state from the components and derive per frame values
+	void Gather();
+
+	// Game thread: file movers that changed cell, rebuilds the hash if the cell size changed
+	void UpdateSpatialHash();
+
+	// Worker threads: accumulate the crowd velocity of the slice [Begin, End) from its neighbours in the hash
+	void ResolveCrowd(int32 Begin, int32 End, float MaxRadius, float DeltaTime);
+
+	// Game thread: rank simulated proxies against the local view and fill HotState.LODs
+	void UpdateProxyLODs();
+
+	// Game thread: push results back to the components
+	void WriteBack(float DeltaTime);
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UVortexMoverComponent>> Movers;
+
+	FVortexMoverHotState HotState;
+	FVortexMoverSpatialHash SpatialHash;
+	bool bCrowdActive = false;
+
+	// Simulated proxy slots sorted by significance, kept to reuse the allocation
+	TArray<int32> ProxyRanking;
+};
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/VortexInputProducer.h"
+#include "VortexScriptedInputProducer.generated.h"
+
+// One step of a scripted input pattern
+USTRUCT(BlueprintType)
+struct FVortexScriptedInputStep
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0.01"))
+	float Duration = 1.0f;
+
+	// X forward, Y right, relative to the scripted control rotation
+	UPROPERTY(EditAnywhere, Category = "Input")
+	FVector2D Move = FVector2D::ZeroVector;
+
+	// Degrees per second added to the control yaw while this step runs
+	UPROPERTY(EditAnywhere, Category = "Input")
+	float YawRate = 0.0f;
+
+	// Jump is pressed at the start of the step and held for JumpHoldTime
+	UPROPERTY(EditAnywhere, Category = "Input")
+	bool bJump = false;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	bool bCrouch = false;
+};
+
+/**
+ * UVortexScriptedInputProducer
+ *
+ * -Input producer without a human behind it, for bots and load tests
+ * -Plays Steps in a loop, or a random pattern generated from Seed when there are none
+ * -Input is a pure function of Seed and sim time, so runs are reproducible and never depend on the frame rate
+ * -Produces for any pawn the sim asks input for (server owned bots have no local controller)
+ * -Never reads the owner snapshot or the routed input events, queued events are discarded
+ */
+UCLASS(EditInlineNew, DefaultToInstanced, CollapseCategories, meta = (DisplayName = "Vortex Scripted Input Producer"))
+class VORTEXMOVER_API UVortexScriptedInputProducer : public UVortexInputProducer
+{
+	GENERATED_BODY()
+public:
+	virtual void ProduceInput_Implementation(int32 SimTimeMs, FMoverInputCmdContext& InputCmdResult) override;
+	virtual void PublishOwnerState() override {}
+
+	void SetSeed(int32 InSeed) { Seed = InSeed; }
+
+protected:
+	UPROPERTY(EditAnywhere, Category = "Input")
+	TArray<FVortexScriptedInputStep> Steps;
+
+	UPROPERTY(EditAnywhere, Category = "Input")
+	int32 Seed = 0;
+
+	// Random pattern: length of each generated step in seconds
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0.1"))
+	float RandomStepDuration = 1.5f;
+
+	// Random pattern: chance for a generated step to jump / crouch / stand still
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0", ClampMax = "1"))
+	float JumpChance = 0.2f;
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0", ClampMax = "1"))
+	float CrouchChance = 0.1f;
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0", ClampMax = "1"))
+	float IdleChance = 0.1f;
+
+	UPROPERTY(EditAnywhere, Category = "Input", meta = (ClampMin = "0"))
+	float JumpHoldTime = 0.2f;
+
+private:
+	struct FSample
+	{
+		FVector2D Move = FVector2D::ZeroVector;
+		float Yaw = 0.0f;
+		bool bJumpHeld = false;
+		bool bCrouchHeld = false;
+	};
+
+	FSample Sample(int32 SimTimeMs) const;
+	FSample SampleSteps(double Time) const;
+	FSample SampleRandom(double Time) const;
+
+	int32 LastSimTimeMs = 0;
+	bool bHasLastSample = false;
+};
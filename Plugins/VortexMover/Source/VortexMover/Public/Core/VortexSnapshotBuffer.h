@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FFloorCheckResult;
+struct FMoverDefaultSyncState;
+struct FProposedMove;
+struct FVortexInputCmd;
+class UPrimitiveComponent;
+
+/**
+ * FVortexSnapshot
+ *
+ * -One simulated frame of a pawn in compact form: end of frame sync state, the input and proposed move it ran with, and the floor it ended on
+ * -Floats instead of doubles, rotations as 16 bit axes and MoveInput in hundredths, precise well below what a reconcile tolerates
+ * -A resimulated frame that starts where the previous snapshot ended and runs with the same input restores its end state from it
+ */
+struct VORTEXMOVER_API FVortexSnapshot
+{
+	enum EButtons : uint8
+	{
+		JumpPressed = 1 << 0,
+		JumpJustPressed = 1 << 1,
+		CrouchPressed = 1 << 2
+	};
+
+	// Server frame of the sim tick, INDEX_NONE while the slot is unused
+	int32 Frame = INDEX_NONE;
+
+	// End of frame sync state, the floor was found from Location
+	FVector3f Location = FVector3f::ZeroVector;
+	FVector3f Velocity = FVector3f::ZeroVector;
+	uint16 Pitch = 0;
+	uint16 Yaw = 0;
+	uint16 Roll = 0;
+
+	// Input of the frame, MoveInput at the precision FVortexInputCmd::SetMoveInput keeps
+	int8 MoveInputX = 0;
+	int8 MoveInputY = 0;
+	int8 MoveInputZ = 0;
+	uint8 Buttons = 0;
+
+	// Proposed move of the frame, input plus whatever layered moves added
+	FVector3f ProposedVelocity = FVector3f::ZeroVector;
+	FVector3f ProposedAngularVelocity = FVector3f::ZeroVector;
+
+	bool bWalkableFloor = false;
+	float FloorDist = 0.0f;
+	FVector3f FloorNormal = FVector3f::UpVector;
+	TWeakObjectPtr<UPrimitiveComponent> FloorPrimitive;
+
+	// The frame touched only static geometry and had no crowd push: the same start, input and move end the same way
+	bool bReplayable = false;
+
+	void SetSyncState(const FMoverDefaultSyncState& SyncState);
+	// Overwrites the transform and velocity of OutSyncState, everything else is left as it is
+	void GetSyncState(FMoverDefaultSyncState& OutSyncState) const;
+	// Returns true if SyncState is where this frame ended, within the precision of the snapshot
+	bool MatchesSyncState(const FMoverDefaultSyncState& SyncState) const;
+
+	void SetInput(const FVortexInputCmd* Cmd, const FProposedMove& ProposedMove);
+	bool MatchesInput(const FVortexInputCmd* Cmd, const FProposedMove& ProposedMove) const;
+
+	void SetFloor(const FFloorCheckResult& Floor);
+	// Rebuilds the recorded floor as seen from InLocation, false if there was no walkable floor
+	bool GetFloor(const FVector& InLocation, FFloorCheckResult& OutFloor) const;
+};
+
+/**
+ * FVortexSnapshotBuffer
+ *
+ * -Fixed capacity ring of FVortexSnapshot per pawn, slot = frame modulo capacity
+ * -Allocated once by Init, recording and lookup never allocate
+ * -Resimulated frames overwrite the frames they replace (replayed ones keep theirs), the buffer always holds the latest timeline
+ * -Thread safety: owned by the simulation, use from the thread that ticks the pawn's movement
+ */
+class VORTEXMOVER_API FVortexSnapshotBuffer
+{
+public:
+	void Init(int32 InCapacity);
+	int32 GetCapacity() const { return Snapshots.Num(); }
+
+	// Returns the slot for Frame, reset for writing. Null before Init.
+	FVortexSnapshot* Write(int32 Frame);
+
+	// Returns the snapshot of Frame if it is still in the buffer
+	const FVortexSnapshot* Find(int32 Frame) const;
+
+private:
+	TArray<FVortexSnapshot> Snapshots;
+};
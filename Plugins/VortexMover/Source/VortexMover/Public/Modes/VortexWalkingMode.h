@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MovementMode.h"
+#include "MoveLibrary/FloorQueryUtils.h"
+#include "VortexWalkingMode.generated.h"
+
+class UVortexMoverComponent;
+class UVortexWalkingSettings;
+struct FMoverDefaultSyncState;
+
+/**
+ * FVortexFloorCache
+ *
+ * -Last floor found by a sweep, reused while the pawn stays close to where it was swept on the same, unmoved primitive
+ * -Per mode instance (one per pawn), never replicated. Resimulation never touches it, see FVortexSnapshotBuffer.
+ * -Every live sweep refreshes it, with vortex.walking.FloorCache off it is never reused but still holds the floor sleep checks
+ */
+struct FVortexFloorCache
+{
+	FFloorCheckResult Floor;
+	TWeakObjectPtr<const UPrimitiveComponent> Primitive;
+	// Floor primitive transform and pawn location at the time of the sweep
+	FTransform PrimitiveTransform;
+	FVector SweepLocation = FVector::ZeroVector;
+	int32 ReusedFrames = 0;
+	bool bValid = false;
+
+	void Invalidate() { bValid = false; Primitive.Reset(); }
+};
+
+// Idle tracking of UVortexWalkingMode, per mode instance like FVortexFloorCache
+struct FVortexWalkingSleep
+{
+	// Consecutive live ticks that met every sleep condition
+	int32 QuietTicks = 0;
+	bool bAsleep = false;
+	FVector Location = FVector::ZeroVector;
+};
+
+/**
+ * UVortexWalkingMode
+ *
+ * -Ground movement driven by FVortexInputCmd, falls with gravity while there is no walkable floor
+ * -Tuning lives in a shared UVortexWalkingSettings asset, the mode instance itself only carries the per pawn floor cache
+ * -Floor check goes through FVortexFloorCache, a new floor sweep is only made once the motion budget is spent or the floor moved
+ * -Records every frame into the owner's FVortexSnapshotBuffer. A resimulated frame that starts from the recorded state with the same
+ *  input takes its end state from it without moving, any other one restores its floor from it instead of sweeping.
+ * -Sleeps after vortex.walking.SleepTicks still ticks on a stable floor with neutral input: ticks then only carry the state over
+ *  and the owning UVortexMoverComponent drops to the idle net update heartbeat.
+ *  Wakes on input, any proposed or crowd velocity, a changed location, or the floor moving or going away.
+ * -Adds the crowd velocity of the owning UVortexMoverComponent to the move without keeping it in the pawn's velocity, live frames only
+ */
+UCLASS(Blueprintable, BlueprintType)
+class VORTEXMOVER_API UVortexWalkingMode : public UBaseMovementMode
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnGenerateMove(const FMoverTickStartData& StartState, const FMoverTimeStep& TimeStep, FProposedMove& OutProposedMove) const override;
+	virtual void OnSimulationTick(const FSimulationTickParams& Params, FMoverTickEndData& OutputState) override;
+
+	// Shared tuning, null uses the UVortexWalkingSettings class defaults
+	const UVortexWalkingSettings* GetSettings() const;
+	void SetSettings(const UVortexWalkingSettings* InSettings) { Settings = InSettings; }
+
+protected:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Vortex")
+	TObjectPtr<const UVortexWalkingSettings> Settings;
+
+private:
+	// Fills OutFloor from the cache if it is still good for Location, otherwise sweeps and refreshes the cache
+	void FindFloor(const FSimulationTickParams& Params, const FVector& Location, FFloorCheckResult& OutFloor);
+	// Resimulation: fills OutFloor from the pawn's snapshot of the frame if Location is still within the motion budget of it
+	bool RestoreFloor(const FSimulationTickParams& Params, const UVortexWalkingSettings& Tuning, const FVector& Location, FFloorCheckResult& OutFloor) const;
+	void RecordSnapshot(const FSimulationTickParams& Params, UVortexMoverComponent* VortexMover, const FMoverDefaultSyncState& SyncState, const FFloorCheckResult& Floor, bool bReplayable) const;
+	// Resimulation: fills OutputSyncState from the pawn's snapshot of the frame if the frame starts and runs as recorded
+	bool ReplaySnapshot(const FSimulationTickParams& Params, const UVortexMoverComponent* VortexMover, const FMoverDefaultSyncState& StartingSyncState, FMoverDefaultSyncState& OutputSyncState) const;
+
+	// Advances the sleep state for this tick, returns true if the pawn sleeps through it
+	bool UpdateSleep(const FSimulationTickParams& Params, const FMoverDefaultSyncState& StartingSyncState, const FVector& CrowdVelocity);
+
+	bool CanReuseFloor(const UVortexWalkingSettings& Tuning, const FVector& Location) const;
+
+	// The only per pawn state, everything else comes from Settings
+	FVortexFloorCache FloorCache;
+	FVortexWalkingSleep Sleep;
+};
@@ -0,0 +1,43 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "VortexWalkingSettings.generated.h"
+
+/**
+ * UVortexWalkingSettings
+ *
+ * -Tuning of UVortexWalkingMode, one asset shared by every pawn that walks the same way
+ * -Read only at runtime, modes read it from the simulation thread. Pawns without an asset use the class defaults.
+ */
+UCLASS(BlueprintType)
+class VORTEXMOVER_API UVortexWalkingSettings : public UPrimaryDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking", meta = (ClampMin = "0", Units = "cm/s"))
+	float MaxSpeed = 600.0f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking", meta = (ClampMin = "0", Units = "cm/s^2"))
+	float Acceleration = 4000.0f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking", meta = (ClampMin = "0", Units = "cm/s^2"))
+	float Deceleration = 8000.0f;
+	// Degrees per second the pawn turns towards its direction of travel, negative turns instantly
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking")
+	float TurningRate = 720.0f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking", meta = (ClampMin = "0", Units = "cm"))
+	float FloorSweepDistance = 40.0f;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Walking", meta = (ClampMin = "0", ClampMax = "90", Units = "deg"))
+	float MaxWalkSlopeAngle = 45.0f;
+
+	// Distance the pawn may move away from the last floor sweep before the floor is swept again, 0 sweeps every tick
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Floor Cache", meta = (ClampMin = "0", Units = "cm"))
+	float FloorCacheDistance = 8.0f;
+	// Ticks a cached floor is reused at most, bounds how long a missed change in the world can go unnoticed
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Floor Cache", meta = (ClampMin = "0"))
+	int32 FloorCacheMaxFrames = 30;
+
+	float GetMaxWalkSlopeCosine() const { return FMath::Cos(FMath::DegreesToRadians(MaxWalkSlopeAngle)); }
+};
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/StaticArray.h"
+#include "Core/VortexInputDataTypes.h"
+
+class UPackageMap;
+
+// How the server fills in input frames a client has not delivered in time, see vortex.net.StarvationPolicy
+enum class EVortexInputStarvationPolicy : uint8
+{
+	// Scale the last input's move down
+	Decay = 0,
+	// Repeat the last input without its single use presses
+	HoldLast = 1,
+	// Continue the trend of the two real input frames before the missing one for a few frames, then decay
+	Extrapolate = 2,
+
+	Num
+};
+
+/**
+ * FVortexInputNetChannel
+ *
+ * -One end of a pawn's sequenced FVortexInputCmd upload stream, see UVortexMoverComponent::GetInputStreamId
+ * -Keyed by stream id rather than connection: Mover serializes input without a package map, so NetSerialize never sees the
+ *  connection. The owning client's producer stamps the id into every command (FVortexInputCmd::NetStreamId), it goes on the wire.
+ * -Stream ids are not authenticated. A modified client can write to another pawn's stream and disturb its delta decoding,
+ *  the commands it sends still only ever drive its own pawn.
+ * -Sequences are the client's input frames (FVortexInputCmd::NetSequence), NPP resending a frame's command reuses its sequence,
+ *  so both histories are keyed by frame and the command after sequence N is the input for the frame after N
+ * -Sender side (client): remembers recently sent commands and the last sequence the server acknowledged
+ * -Receiver side (server): remembers recently received commands so deltas can be rebuilt, and which sequence to acknowledge
+ * -Delta sends are only ever made against an acknowledged command, so packet loss can never desync the baseline
+ * -Optionally repeats the previous unacknowledged commands in every send (redundancy window) so the server can recover lost ones
+ * -Thread safety: game thread only (legacy RPC serialization and component ticks)
+ */
+struct VORTEXMOVER_API FVortexInputNetChannel
+{
+	// Must be a power of two and smaller than the sequence range
+	static constexpr int32 HistorySize = 32;
+	static constexpr int32 SequenceBits = 8;
+	static constexpr int32 BaselineDistanceBits = 5;
+	static constexpr int32 RedundancyCountBits = 3;
+	static constexpr int32 MaxRedundancy = (1 << RedundancyCountBits) - 1;
+
+	struct FHistoryEntry
+	{
+		FVortexInputCmd Cmd;
+		uint8 Sequence = 0;
+		bool bValid = false;
+	};
+
+	// Sender totals (client), and receiver totals (server): how often missing input could be recovered from redundancy instead of synthesized
+	struct FStats
+	{
+		uint32 Sent = 0;
+		uint32 SentAsDelta = 0;
+
+		uint32 Received = 0;
+		uint32 RecoveredFromRedundancy = 0;
+		uint32 Synthesized = 0;
+
+		// Synthesized input compared with the real input once it arrived
+		uint32 Predictions = 0;
+		double MoveErrorSum = 0.0;
+		double AngleErrorSum = 0.0;
+	};
+
+	// Returns true if sequence A is more recent than B, handling wrap around
+	static bool IsSequenceNewer(uint8 A, uint8 B) { return static_cast<int8>(A - B) > 0; }
+
+	// Stream id, the same on the sending client and the server
+	uint32 Id = 0;
+	FStats Stats;
+
+	// Sender
+	uint8 LastSentSequence = 0;
+	bool bHasSent = false;
+	uint8 AckedSequence = 0;
+	bool bHasAck = false;
+	TStaticArray<FHistoryEntry, HistorySize> SendHistory;
+
+	// Receiver
+	uint8 LastReceivedSequence = 0;
+	bool bHasReceived = false;
+	bool bAckPending = false;
+	double LastAckSendTime = 0.0;
+	TStaticArray<FHistoryEntry, HistorySize> ReceiveHistory;
+	// Latest synthesized input and the frame it stood in for, scored once the real input of that frame arrives
+	FVortexInputCmd LastPrediction;
+	uint8 LastPredictionSequence = 0;
+	bool bHasPrediction = false;
+	// Newest frame the server ran short of input for, Decay may be asked for the same frame more than once
+	uint8 LastStarvedSequence = 0;
+	bool bHasStarved = false;
+
+	// Returns the acknowledged command to delta the command for Sequence against, or null if a full send is required
+	const FVortexInputCmd* FindSendBaseline(uint8 Sequence, uint8& OutDistance) const;
+
+	// Returns the received command with the given sequence, or null if it is no longer in the history
+	const FVortexInputCmd* FindReceived(uint8 Sequence) const;
+
+	void RecordSent(uint8 Sequence, const FVortexInputCmd& Cmd);
+	void RecordReceived(uint8 Sequence, const FVortexInputCmd& Cmd);
+
+	// Client: the server confirmed it holds the command with this sequence
+	void OnAckReceived(uint8 Sequence);
+};
+
+namespace VortexInputNet
+{
+	// Server: opens the receiving end of a new stream and returns its id, never 0. Only registered streams are decoded.
+	VORTEXMOVER_API uint32 AddReceiveStream();
+	VORTEXMOVER_API void RemoveReceiveStream(uint32 StreamId);
+	VORTEXMOVER_API FVortexInputNetChannel* FindReceiveChannel(uint32 StreamId);
+
+	// Client: the sending end is opened by the first upload on the stream
+	VORTEXMOVER_API void RemoveSendStream(uint32 StreamId);
+	VORTEXMOVER_API FVortexInputNetChannel* FindSendChannel(uint32 StreamId);
+
+	// Writes or reads one command of the sequenced stream, stream id included. Returns false and sets the archive error if the
+	// command could not be decoded (unknown stream, missing delta baseline): the frame is lost rather than guessed.
+	bool SerializeSequenced(FVortexInputCmd& Cmd, FArchive& Ar, UPackageMap* Map, EVortexInputWireFormat Format);
+
+	// Server: InOutCmd is a copy of the last command being reused for a missing frame, the frame after InOutCmd.NetSequence,
+	// and Channel the stream it was decoded from (FindReceiveChannel(InOutCmd.NetChannelId)).
+	// Replaces it with the real command for that frame if it arrived and returns true. Otherwise counts the frame as
+	// synthesized, once per frame, and advances InOutCmd.NetSequence to it so a further miss targets the frame after.
+	bool TryRecoverNextInput(FVortexInputNetChannel& Channel, FVortexInputCmd& InOutCmd);
+
+	// Server: fills in a missing input frame from InOutCmd (the last command used) with the active starvation policy.
+	// Channel may be null for commands that did not come from a stream, only the policies that need no history apply then.
+	void SynthesizeInput(FVortexInputNetChannel* Channel, FVortexInputCmd& InOutCmd, float DecayAmount);
+}
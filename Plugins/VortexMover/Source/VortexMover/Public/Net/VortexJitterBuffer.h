@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * FVortexJitterBuffer
+ *
+ * -Buffers the transforms a simulated proxy receives and plays them back a little in the past, interpolating between them
+ * -Samples are placed on a steady timeline that follows the arrival clock, so uneven arrival is not replayed as uneven motion
+ * -Delay adapts: target = mean arrival interval + vortex.smoothing.JitterScale * mean deviation, clamped to Min/MaxDelay.
+ *  It grows as soon as jitter rises or the buffer runs dry (underrun), and shrinks slowly while arrivals are steady.
+ * -Fed one sample per received FVortexProxyState, timed by its arrival. Holding the newest sample counts as an underrun
+ *  only if another one follows shortly, a longer gap (idle pawn at a low net update rate) restarts the timeline.
+ * -Fixed capacity, no allocation
+ */
+class VORTEXMOVER_API FVortexJitterBuffer
+{
+public:
+	static constexpr int32 Capacity = 16;
+
+	void AddSample(double ArrivalTime, const FTransform& Transform);
+
+	// Transform to show at Now, false until a sample arrived
+	bool Evaluate(double Now, float DeltaTime, FTransform& OutTransform);
+
+	void Reset();
+	// Drops the buffered samples but keeps the measured arrival timing, delay and underrun count
+	void ResetTimeline();
+
+	double GetDelay() const { return Delay; }
+	double GetJitter() const { return Jitter; }
+	uint32 GetNumUnderruns() const { return NumUnderruns; }
+
+private:
+	struct FSample
+	{
+		double Time = 0.0;
+		FTransform Transform;
+	};
+
+	const FSample& GetSample(int32 Age) const { return Samples[(Head - Age + Capacity) % Capacity]; }
+
+	FSample Samples[Capacity];
+	// Index of the newest sample
+	int32 Head = INDEX_NONE;
+	int32 NumSamples = 0;
+
+	double LastArrivalTime = 0.0;
+	double MeanInterval = 0.0;
+	double Jitter = 0.0;
+	double Delay = 0.0;
+	// Playback reached the newest sample and is holding it
+	bool bHolding = false;
+	uint32 NumUnderruns = 0;
+};
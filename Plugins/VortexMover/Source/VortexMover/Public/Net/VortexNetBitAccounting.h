@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UPackageMap;
+
+/**
+ * FVortexNetBitField
+ *
+ * -One accounted field of a Vortex net struct, declared once as a static next to the struct's NetSerialize
+ * -Every struct also declares a "Total" field around its whole NetSerialize so headers and masks show up as the difference
+ */
+struct VORTEXMOVER_API FVortexNetBitField
+{
+	static constexpr int32 MaxFields = 32;
+
+	FVortexNetBitField(const TCHAR* InStructName, const TCHAR* InFieldName);
+
+	const TCHAR* StructName;
+	const TCHAR* FieldName;
+	// INDEX_NONE if MaxFields was exceeded, the field is then never counted
+	int32 Index = INDEX_NONE;
+	FName CsvStatName;
+};
+
+/**
+ * FVortexNetBitScope
+ *
+ * -Counts the bits written or read between construction and destruction towards Field and Map's connection
+ * -Does nothing unless vortex.debug.NetBits is on. Without a Map the package map of the FNetBitWriter/FNetBitReader is used,
+ *  which is how Mover's data collections call NetSerialize. Local measurements (bit reports, benchmarks) have neither.
+ * -Only measures archives that are exactly FBitWriter/FBitReader or their net variants, anything else is skipped
+ */
+class VORTEXMOVER_API FVortexNetBitScope
+{
+public:
+	FVortexNetBitScope(FArchive& InAr, const UPackageMap* InMap, const FVortexNetBitField& InField);
+	~FVortexNetBitScope();
+
+private:
+	FArchive& Ar;
+	const UPackageMap* Map;
+	const FVortexNetBitField& Field;
+	int64 StartBits = INDEX_NONE;
+	uint8 ArchiveType = 0;
+};
+
+/**
+ * Net bit accounting
+ *
+ * -Totals are kept per connection and direction, and published once per second by a core ticker, also while nothing is sent:
+ *  stats (Net Bits Sent/Received per second), CSV NetBits_<Struct>_<Field> and NetBitsMaxConnection
+ * -vortex.debug.NetBitsReport logs every connection's per field breakdown
+ * -Thread safety: any thread, NetSerialize may run off the game thread. The totals are guarded by a lock.
+ */
+namespace VortexNetBits
+{
+	VORTEXMOVER_API bool IsEnabled();
+	VORTEXMOVER_API void Record(const UPackageMap* Map, const FVortexNetBitField& Field, bool bSending, int64 Bits);
+	// Stops publishing, called when the module shuts down
+	void Shutdown();
+}
@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VortexProxyState.generated.h"
+
+/**
+ * FVortexProxyState
+ *
+ * -Authority transform of a pawn whose simulated proxies use the adaptive jitter buffer, replicated by UVortexMoverComponent
+ * -Carries what the authority simulated, so proxies buffer what was received rather than what NPP interpolated
+ * -Restamped only when the pawn moved, an idle or sleeping pawn has nothing new to send
+ * -ArrivalTime is stamped when a proxy receives it, the jitter buffer measures network timing from it
+ * -NetSerialize is the generic replication path, Iris uses FVortexProxyStateNetSerializer
+ */
+USTRUCT()
+struct VORTEXMOVER_API FVortexProxyState
+{
+	GENERATED_BODY()
+
+	// Sim frame the transform was recorded on, INDEX_NONE until written
+	UPROPERTY()
+	int32 ServerFrame = INDEX_NONE;
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	FRotator Orientation = FRotator::ZeroRotator;
+
+	// FPlatformTime::Seconds() when this state was received. Local only, not replicated.
+	double ArrivalTime = 0.0;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FVortexProxyState& Other) const
+	{
+		return ServerFrame == Other.ServerFrame && Location == Other.Location && Orientation == Other.Orientation;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FVortexProxyState> : public TStructOpsTypeTraitsBase2<FVortexProxyState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
@@ -0,0 +1,178 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Core/VortexInputDataTypes.h"
+#include "Tasks/Task.h"
+#include <atomic>
+
+class IFileHandle;
+
+/**
+ * Input capture file layout
+ *
+ * -<Name>.vxin: append only records, 16 byte header then per record a header byte, stream id and sim time.
+ *  Command records carry only the fields that changed since the stream's previous command, as raw doubles, so replays are bit exact.
+ *  Every KeyframeInterval commands of a stream (and after a dropped one) the record carries all fields instead.
+ *  Stream records declare a stream id's name (owning actor), written before its first command.
+ *  Records are self delimiting, the file decodes front to back without the index.
+ * -<Name>.vxidx: 16 byte header then fixed size FVortexInputCaptureIndexEntry seek points, memory mappable: every stream record
+ *  and every full command record. Loading resumes at the next seek point past a corrupt record.
+ */
+struct FVortexInputCaptureIndexEntry
+{
+	enum EKind : uint8
+	{
+		Command = 0,
+		Stream = 1
+	};
+
+	// Byte offset of the record in the data file, ascending
+	uint64 Offset = 0;
+	int32 SimTimeMs = 0;
+	uint16 StreamId = 0;
+	uint8 Kind = Command;
+	uint8 Reserved = 0;
+};
+static_assert(sizeof(FVortexInputCaptureIndexEntry) == 16, "Index entries are mapped directly, keep them 16 bytes");
+
+/**
+ * FVortexInputRecorder
+ *
+ * -Writes the input commands consumed by every simulating pawn to a capture file
+ * -Records go to a preallocated buffer, full buffers are swapped and written by a background task.
+ *  Nothing is allocated per record, and a record is dropped rather than block when both buffers are busy.
+ * -Thread safety: Append and AddStream may be called from any thread
+ */
+class VORTEXMOVER_API FVortexInputRecorder
+{
+public:
+	static constexpr int32 DataBufferSize = 64 * 1024;
+	static constexpr int32 IndexBufferSize = 16 * 1024;
+	// Commands per stream between two full records, each full record gets an index entry
+	static constexpr int32 KeyframeInterval = 64;
+	// Seconds before a partly filled buffer is flushed anyway, bounds what a crash can lose
+	static constexpr double FlushInterval = 1.0;
+
+	~FVortexInputRecorder();
+
+	// Opens <BasePath>.vxin and <BasePath>.vxidx, returns null if they could not be created
+	static TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> Create(const FString& BasePath);
+
+	// Returns the id new commands of this stream are recorded under
+	uint16 AddStream(const FString& Name);
+	void Append(uint16 StreamId, int32 SimTimeMs, const FVortexInputCmd& Cmd);
+
+	// Writes what is buffered and closes the files, later appends are ignored
+	void Close();
+
+	uint64 GetNumRecorded() const { return NumRecorded; }
+	uint64 GetNumDropped() const { return NumDropped; }
+
+private:
+	struct FBuffer
+	{
+		TArray<uint8> Data;
+		TArray<uint8> Index;
+	};
+
+	// Called with Lock held, returns false if the other buffer is still being written
+	bool TrySwapBuffers();
+	void WriteBuffer(FBuffer& Buffer);
+	void AppendIndex(FBuffer& Buffer, uint8 Kind, uint16 StreamId, int32 SimTimeMs);
+
+	FCriticalSection Lock;
+	FBuffer Buffers[2];
+	int32 ActiveBuffer = 0;
+	std::atomic<bool> bFlushInFlight = false;
+	UE::Tasks::FTask FlushTask;
+	double LastFlushTime = 0.0;
+	bool bClosed = false;
+
+	TUniquePtr<IFileHandle> DataFile;
+	TUniquePtr<IFileHandle> IndexFile;
+	// Data file size including everything still buffered
+	uint64 DataOffset = 0;
+
+	// Previous command per stream, commands only store what changed. Invalidated when a record is dropped.
+	TArray<FVortexInputCmd> LastCmds;
+	TBitArray<> HasLastCmd;
+	// Commands recorded per stream since its last full record
+	TArray<uint16> CommandsSinceKeyframe;
+
+	uint64 NumRecorded = 0;
+	uint64 NumDropped = 0;
+};
+
+/**
+ * FVortexInputReplay
+ *
+ * -A capture file loaded for replay, one stream of commands per recorded pawn
+ * -Producers claim a stream by their owner's name, or the next unclaimed one if the names differ between sessions
+ * -Thread safety: immutable after load except for claiming, which is locked
+ */
+class VORTEXMOVER_API FVortexInputReplay
+{
+public:
+	struct FFrame
+	{
+		int32 SimTimeMs = 0;
+		FVortexInputCmd Cmd;
+	};
+
+	struct FStream
+	{
+		FString Name;
+		TArray<FFrame> Frames;
+		bool bClaimed = false;
+	};
+
+	// Maps and decodes <BasePath>.vxin, using the seek points in <BasePath>.vxidx to skip corrupt records.
+	// Returns null if either file is missing or has a bad header.
+	static TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> Load(const FString& BasePath);
+
+	// Returns the claimed stream index, INDEX_NONE once every stream is taken
+	int32 ClaimStream(const FString& Name);
+
+	const FStream& GetStream(int32 Index) const { return Streams[Index]; }
+	int32 NumStreams() const { return Streams.Num(); }
+
+private:
+	FCriticalSection ClaimLock;
+	TArray<FStream> Streams;
+};
+
+// Per pawn handles into the active recording or replay, refreshed whenever a capture starts or stops
+struct FVortexInputRecordCursor
+{
+	uint32 Generation = 0;
+	uint16 StreamId = 0;
+	TSharedPtr<FVortexInputRecorder, ESPMode::ThreadSafe> Recorder;
+};
+
+struct FVortexInputReplayCursor
+{
+	uint32 Generation = 0;
+	int32 StreamIndex = INDEX_NONE;
+	int32 FrameIndex = 0;
+	// Replay sim time minus recorded sim time, fixed by the first replayed frame
+	int32 SimTimeOffsetMs = 0;
+	bool bStarted = false;
+	TSharedPtr<FVortexInputReplay, ESPMode::ThreadSafe> Replay;
+};
+
+namespace VortexInputCapture
+{
+	// Files live in Saved/VortexInput/<Name>
+	VORTEXMOVER_API bool StartRecording(const FString& Name);
+	VORTEXMOVER_API void StopRecording();
+	VORTEXMOVER_API bool StartReplay(const FString& Name);
+	VORTEXMOVER_API void StopReplay();
+
+	// Appends Cmd to the active recording under Owner's stream, does nothing (and takes no lock) when not recording
+	VORTEXMOVER_API void Record(FVortexInputRecordCursor& Cursor, const UObject* Owner, int32 SimTimeMs, const FVortexInputCmd& Cmd);
+
+	// Replaces OutCmd with the recorded command for this sim time and returns true while Owner's stream has frames left
+	VORTEXMOVER_API bool Replay(FVortexInputReplayCursor& Cursor, const UObject* Owner, int32 SimTimeMs, FVortexInputCmd& OutCmd);
+}
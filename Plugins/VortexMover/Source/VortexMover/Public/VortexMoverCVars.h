@@ -8,4 +8,136 @@ namespace VortexMoverCVars
 {
 	// Returns: 0=off, 1=per frame, 2=on change
 	int32 IsInputDebugEnabled();
+
+	// Returns true if the bits of Vortex net struct fields are counted per connection
+	bool IsNetBitAccountingEnabled();
+
+	// Returns true if client input uploads may be delta compressed against the last acknowledged command
+	bool IsInputDeltaEnabled();
+
+	// Returns: minimum seconds between input acknowledgements sent by the server
+	float GetInputAckInterval();
+
+	// Returns: 0=legacy, 1=compact FVortexInputCmd wire layout, the same on server and clients
+	int32 GetInputWireFormat();
+
+	// Returns: bits per ControlRotation axis in the compact layout
+	int32 GetInputRotationBits();
+
+	// Returns: number of older unacknowledged input commands repeated in every upload
+	int32 GetInputRedundancy();
+
+	// Returns: 0=decay, 1=hold last, 2=extrapolate, how the server fills in input frames the client has not delivered
+	int32 GetStarvationPolicy();
+
+	// Returns: share of MoveInput removed per synthesized frame at full decay amount
+	float GetStarvationDecayRate();
+
+	// Returns: exponent applied to the decay amount, shapes the decay curve
+	float GetStarvationDecayExponent();
+
+	// Returns: synthesized frames extrapolated before falling back to decay
+	int32 GetStarvationExtrapolationFrames();
+
+	// Returns: per axis MoveInput difference tolerated before an input reconcile
+	float GetReconcileMoveInputTolerance();
+
+	// Returns: degrees of ControlRotation/OrientationInput difference tolerated before an input reconcile
+	float GetReconcileAngleTolerance();
+
+	// Returns: movers per UVortexMoverSubsystem crowd pass batch
+	int32 GetSubsystemBatchSize();
+
+	// Returns true if UVortexMoverSubsystem crowd pass batches may run on worker threads
+	bool IsSubsystemParallelEnabled();
+
+	// Returns true if the input producer integrates timestamped input over each sim tick's window
+	bool IsInputSubTickAccumulationEnabled();
+
+	// Returns: seconds the input window may trail real time before it is resynced
+	float GetInputWindowMaxLag();
+
+	// Returns true if the subsystem's crowd pass steers movers no client predicts apart
+	bool IsCrowdEnabled();
+
+	// Returns: edge length (cm) of a crowd spatial hash cell
+	float GetCrowdCellSize();
+
+	// Returns: capsule gap (cm) below which movers steer apart
+	float GetCrowdAvoidanceMargin();
+
+	// Returns: avoidance push speed (cm/s) at contact
+	float GetCrowdAvoidanceSpeed();
+
+	// Returns: maximum overlap resolution speed (cm/s)
+	float GetCrowdMaxPushSpeed();
+
+	// Returns true if UVortexWalkingMode may reuse its cached floor instead of sweeping
+	bool IsFloorCacheEnabled();
+
+	// Returns: frames of movement snapshots kept per pawn
+	int32 GetSnapshotFrames();
+
+	// Returns: lower bound (seconds) of the adaptive proxy interpolation delay
+	float GetSmoothingMinDelay();
+
+	// Returns: upper bound (seconds) of the adaptive proxy interpolation delay
+	float GetSmoothingMaxDelay();
+
+	// Returns: multiple of the measured jitter added to the proxy interpolation delay
+	float GetSmoothingJitterScale();
+
+	// Returns: seconds of proxy interpolation delay dropped per second on a steady connection
+	float GetSmoothingShrinkRate();
+
+	// Returns: frames of server side capsule history kept per pawn for rewinding
+	int32 GetLagCompHistoryFrames();
+
+	// Returns: upper bound (cm/s) of pawn speed assumed by rewind queries
+	float GetLagCompMaxSpeed();
+
+	// Returns true if simulated proxy smoothing quality follows significance
+	bool IsLODEnabled();
+
+	// Returns: simulated proxies kept at full smoothing quality
+	int32 GetLODFullMovers();
+
+	// Returns: distance (cm) within which on screen proxies outside the budget still smooth, at a reduced rate
+	float GetLODReducedDistance();
+
+	// Returns: smoothing updates per second of reduced tier proxies
+	float GetLODReducedRate();
+
+	// Returns: distance multiplier applied to off screen proxies when ranking
+	float GetLODOffscreenScale();
+
+	// Returns true if the server adapts Vortex pawns' NetUpdateFrequency to their movement
+	bool IsNetRateEnabled();
+
+	// Returns: net updates per second of pawns changing velocity quickly
+	float GetNetRateMaxFrequency();
+
+	// Returns: net updates per second of pawns moving steadily
+	float GetNetRateMinFrequency();
+
+	// Returns: heartbeat net updates per second of idle and sleeping pawns
+	float GetNetRateIdleFrequency();
+
+	// Returns: quiet frames before a pawn counts as idle
+	int32 GetNetRateIdleFrames();
+
+	// Returns: velocity change (cm/s^2) that earns the max net update frequency
+	float GetNetRateFullRateAcceleration();
+
+	// Returns: viewer distance (cm) beyond which net priority falls off
+	float GetNetPriorityDistance();
+
+	// Returns: net priority multiplier of pawns behind the viewer
+	float GetNetPriorityOutOfViewScale();
+
+	// Returns: net priority multiplier of idle pawns
+	float GetNetPriorityIdleScale();
+
+	// Returns: still ticks before a walking pawn falls asleep, 0 disables sleeping
+	int32 GetSleepTicks();
 }
\ No newline at end of file
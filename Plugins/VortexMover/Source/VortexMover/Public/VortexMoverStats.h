@@ -0,0 +1,11 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+
+DECLARE_STATS_GROUP(TEXT("VortexMover"), STATGROUP_VortexMover, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(VORTEXMOVER_API, VortexMover);
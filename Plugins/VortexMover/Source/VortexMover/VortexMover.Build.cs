@@ -42,6 +42,9 @@ public class VortexMover : ModuleRules
 			);
 		
 		
+		// FVortexProxyStateNetSerializer is compiled only when the target replicates through Iris
+		SetupIrisSupport(Target);
+
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]
 			{
@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VDemoBotPawn.h"
+
+#include "Core/VortexScriptedInputProducer.h"
+
+AVDemoBotPawn::AVDemoBotPawn(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UVortexScriptedInputProducer>(TEXT("VortexInputProducer")))
+{
+	AutoPossessAI = EAutoPossessAI::Disabled;
+}
+
+void AVDemoBotPawn::SetInputSeed(int32 Seed)
+{
+	if (UVortexScriptedInputProducer* ScriptedProducer = Cast<UVortexScriptedInputProducer>(GetInputProducer()))
+	{
+		ScriptedProducer->SetSeed(Seed);
+	}
+}
@@ -0,0 +1,349 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "VDemoLoadTestSubsystem.h"
+
+#include "EngineUtils.h"
+#include "VDemoBotPawn.h"
+#include "VortexMoverLogChannels.h"
+#include "Core/VortexInputDataTypes.h"
+#include "Core/VortexMoverComponent.h"
+#include "Core/VortexMoverSubsystem.h"
+#include "Engine/NetDriver.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Net/VortexProxyState.h"
+#include "UObject/CoreNet.h"
+
+namespace
+{
+	// Grid spacing between spawned bots, wide enough for the capsule
+	constexpr float BotSpacing = 200.0f;
+
+	// Bits one send of the bot's Vortex owned state takes: its proxy state if it has one and its last input command, written the
+	// way replication writes them. Mover's own sync state is left out, its movement base needs a connection's package map.
+	int64 GetSerializedStateBits(const UVortexMoverComponent& Mover)
+	{
+		FNetBitWriter Writer(nullptr, 1024);
+		bool bSuccess = false;
+
+		if (Mover.UsesProxyJitterBuffer())
+		{
+			FVortexProxyState Copy(Mover.GetProxyState());
+			Copy.NetSerialize(Writer, nullptr, bSuccess);
+		}
+		if (const FVortexInputCmd* InputCmd = Mover.GetLastInputCmd().InputCollection.FindDataByType<FVortexInputCmd>())
+		{
+			FVortexInputCmd Copy(*InputCmd);
+			Copy.NetStreamId = 0;
+			Copy.NetSerialize(Writer, nullptr, bSuccess);
+		}
+		return Writer.GetNumBits();
+	}
+
+	FAutoConsoleCommandWithWorldAndArgs StartLoadTestCommand(
+		TEXT("vortex.loadtest.Start"),
+		TEXT("Spawns bots and records server frame time, movement cost per pawn and bandwidth to a CSV.\n")
+		TEXT("Usage: vortex.loadtest.Start <Bots> [DurationSeconds=60] [Seed=0]\n"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UVDemoLoadTestSubsystem* Subsystem = UWorld::GetSubsystem<UVDemoLoadTestSubsystem>(World);
+			if (!Subsystem || Args.IsEmpty())
+			{
+				return;
+			}
+
+			const int32 NumBots = FCString::Atoi(*Args[0]);
+			const float Duration = Args.IsValidIndex(1) ? FCString::Atof(*Args[1]) : 60.0f;
+			const int32 Seed = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : 0;
+			Subsystem->StartLoadTest(NumBots, Duration, Seed);
+		}));
+
+	FAutoConsoleCommandWithWorld StopLoadTestCommand(
+		TEXT("vortex.loadtest.Stop"),
+		TEXT("Ends the running load test early and writes its CSV.\n"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (UVDemoLoadTestSubsystem* Subsystem = UWorld::GetSubsystem<UVDemoLoadTestSubsystem>(World))
+			{
+				Subsystem->StopLoadTest();
+			}
+		}));
+}
+
+void UVDemoLoadTestSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	int32 NumBots = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("VortexLoadTest="), NumBots) && NumBots > 0)
+	{
+		float RunDuration = 60.0f;
+		int32 Seed = 0;
+		FParse::Value(FCommandLine::Get(), TEXT("VortexLoadTestDuration="), RunDuration);
+		FParse::Value(FCommandLine::Get(), TEXT("VortexLoadTestSeed="), Seed);
+		StartLoadTest(NumBots, RunDuration, Seed, true);
+	}
+}
+
+void UVDemoLoadTestSubsystem::Deinitialize()
+{
+	if (bRunning)
+	{
+		bExitWhenDone = false;
+		StopLoadTest();
+	}
+
+	Super::Deinitialize();
+}
+
+bool UVDemoLoadTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UVDemoLoadTestSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UVDemoLoadTestSubsystem, STATGROUP_Tickables);
+}
+
+void UVDemoLoadTestSubsystem::StartLoadTest(int32 NumBots, float InDuration, int32 Seed, bool bInExitWhenDone)
+{
+	UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogVortexMover, Warning, TEXT("Load test: bots can only be spawned on the server"));
+		return;
+	}
+
+	if (bRunning)
+	{
+		StopLoadTest();
+	}
+
+	SpawnBots(FMath::Max(NumBots, 0), Seed);
+
+	// Discard cost gathered before the run
+	if (const UVortexMoverSubsystem* MoverSubsystem = World->GetSubsystem<UVortexMoverSubsystem>())
+	{
+		for (UVortexMoverComponent* Mover : MoverSubsystem->GetMovers())
+		{
+			uint64 Cycles;
+			uint32 Ticks;
+			Mover->ConsumeSimulationCost(Cycles, Ticks);
+		}
+	}
+
+	bRunning = true;
+	bExitWhenDone = bInExitWhenDone;
+	Duration = FMath::Max(InDuration, 1.0f);
+	StartTime = FPlatformTime::Seconds();
+	SampleStartTime = StartTime;
+	SampleFrames = 0;
+	SampleFrameTime = SampleFrameTimeMax = SampleWorkTime = 0.0;
+	TotalFrames = 0;
+	TotalFrameTime = TotalWorkTime = 0.0;
+	TotalSimCycles = TotalSimTicks = TotalInBytes = TotalOutBytes = 0;
+	TotalStateBits = 0.0;
+	NumStateSamples = 0;
+
+	CsvLines.Reset();
+	CsvLines.Add(TEXT("Time,Bots,FrameMs,FrameMaxMs,FrameWorkMs,SimTicks,SimUsPerPawnTick,SimMsPerFrame,StateBitsPerBot,InKBps,OutKBps,Connections"));
+
+	UE_LOG(LogVortexMover, Log, TEXT("Load test: started with %d bots for %.0fs, seed %d"), Bots.Num(), Duration, Seed);
+
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	if (!NetDriver || NetDriver->ClientConnections.IsEmpty())
+	{
+		UE_LOG(LogVortexMover, Warning, TEXT("Load test: no client connections, InKBps/OutKBps stay 0. Bandwidth needs connected clients, StateBitsPerBot is measured without them."));
+	}
+}
+
+void UVDemoLoadTestSubsystem::StopLoadTest()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	bRunning = false;
+	if (SampleFrames > 0)
+	{
+		FlushSample();
+	}
+	WriteReport();
+	DestroyBots();
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UVDemoLoadTestSubsystem::Tick(float DeltaTime)
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	// Idle time is the wait for the server tick rate cap, what is left is the frame's actual work
+	const double FrameTime = FApp::GetDeltaTime();
+	++SampleFrames;
+	SampleFrameTime += FrameTime;
+	SampleFrameTimeMax = FMath::Max(SampleFrameTimeMax, FrameTime);
+	SampleWorkTime += FMath::Max(FrameTime - FApp::GetIdleTime(), 0.0);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - SampleStartTime >= SampleInterval)
+	{
+		FlushSample();
+	}
+	if (Now - StartTime >= Duration)
+	{
+		StopLoadTest();
+	}
+}
+
+void UVDemoLoadTestSubsystem::SpawnBots(int32 NumBots, int32 Seed)
+{
+	UWorld* World = GetWorld();
+
+	// Square grid centered on the first player start
+	FVector Origin(0.0f, 0.0f, 100.0f);
+	for (TActorIterator<APlayerStart> It(World); It; ++It)
+	{
+		Origin = It->GetActorLocation();
+		break;
+	}
+
+	const int32 GridSize = FMath::CeilToInt32(FMath::Sqrt(static_cast<float>(NumBots)));
+	const FVector GridOffset(-0.5f * (GridSize - 1) * BotSpacing, -0.5f * (GridSize - 1) * BotSpacing, 0.0f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	Bots.Reserve(NumBots);
+	for (int32 Index = 0; Index < NumBots; ++Index)
+	{
+		const FVector Location = Origin + GridOffset + FVector((Index % GridSize) * BotSpacing, (Index / GridSize) * BotSpacing, 0.0f);
+		if (AVDemoBotPawn* Bot = World->SpawnActor<AVDemoBotPawn>(AVDemoBotPawn::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			Bot->SetInputSeed(Seed + Index);
+			Bots.Add(Bot);
+		}
+	}
+}
+
+void UVDemoLoadTestSubsystem::DestroyBots()
+{
+	for (AVDemoBotPawn* Bot : Bots)
+	{
+		if (IsValid(Bot))
+		{
+			Bot->Destroy();
+		}
+	}
+	Bots.Reset();
+}
+
+void UVDemoLoadTestSubsystem::FlushSample()
+{
+	const UWorld* World = GetWorld();
+
+	uint64 SimCycles = 0;
+	uint64 SimTicks = 0;
+	if (const UVortexMoverSubsystem* MoverSubsystem = World->GetSubsystem<UVortexMoverSubsystem>())
+	{
+		for (UVortexMoverComponent* Mover : MoverSubsystem->GetMovers())
+		{
+			uint64 Cycles;
+			uint32 Ticks;
+			Mover->ConsumeSimulationCost(Cycles, Ticks);
+			SimCycles += Cycles;
+			SimTicks += Ticks;
+		}
+	}
+
+	// The state as it is now, once per row
+	int64 StateBits = 0;
+	int32 NumMeasured = 0;
+	for (const AVDemoBotPawn* Bot : Bots)
+	{
+		if (const UVortexMoverComponent* Mover = IsValid(Bot) ? Bot->FindComponentByClass<UVortexMoverComponent>() : nullptr)
+		{
+			StateBits += GetSerializedStateBits(*Mover);
+			++NumMeasured;
+		}
+	}
+	const double StateBitsPerBot = NumMeasured > 0 ? static_cast<double>(StateBits) / NumMeasured : 0.0;
+
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	const uint32 InBytesPerSecond = NetDriver ? NetDriver->InBytesPerSecond : 0;
+	const uint32 OutBytesPerSecond = NetDriver ? NetDriver->OutBytesPerSecond : 0;
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+
+	const double Now = FPlatformTime::Seconds();
+	const double SimMs = FPlatformTime::ToMilliseconds64(SimCycles);
+	const int32 Frames = FMath::Max(SampleFrames, 1);
+
+	CsvLines.Add(FString::Printf(TEXT("%.2f,%d,%.3f,%.3f,%.3f,%llu,%.3f,%.3f,%.1f,%.2f,%.2f,%d"),
+		Now - StartTime,
+		Bots.Num(),
+		SampleFrameTime * 1000.0 / Frames,
+		SampleFrameTimeMax * 1000.0,
+		SampleWorkTime * 1000.0 / Frames,
+		SimTicks,
+		SimTicks > 0 ? SimMs * 1000.0 / SimTicks : 0.0,
+		SimMs / Frames,
+		StateBitsPerBot,
+		InBytesPerSecond / 1024.0,
+		OutBytesPerSecond / 1024.0,
+		NumConnections));
+
+	TotalFrames += SampleFrames;
+	TotalFrameTime += SampleFrameTime;
+	TotalWorkTime += SampleWorkTime;
+	TotalSimCycles += SimCycles;
+	TotalSimTicks += SimTicks;
+	TotalStateBits += StateBitsPerBot;
+	++NumStateSamples;
+	TotalInBytes += static_cast<uint64>(InBytesPerSecond * (Now - SampleStartTime));
+	TotalOutBytes += static_cast<uint64>(OutBytesPerSecond * (Now - SampleStartTime));
+
+	SampleStartTime = Now;
+	SampleFrames = 0;
+	SampleFrameTime = SampleFrameTimeMax = SampleWorkTime = 0.0;
+}
+
+void UVDemoLoadTestSubsystem::WriteReport()
+{
+	const FString MapName = GetWorld()->GetMapName();
+	const FString FileName = FPaths::ProfilingDir() / TEXT("VortexLoadTest") / FString::Printf(TEXT("%s_%dBots_%s.csv"), *MapName, Bots.Num(), *FDateTime::Now().ToString());
+	const bool bSaved = FFileHelper::SaveStringArrayToFile(CsvLines, *FileName);
+
+	const double RunTime = FMath::Max(FPlatformTime::Seconds() - StartTime, UE_SMALL_NUMBER);
+	const int32 Frames = FMath::Max(TotalFrames, 1);
+	UE_LOG(LogVortexMover, Log, TEXT("Load test: %d bots, %.0fs, frame %.3fms (work %.3fms), sim %.3fus per pawn tick, state %.1f bits per bot, in %.2fKB/s, out %.2fKB/s"),
+		Bots.Num(),
+		RunTime,
+		TotalFrameTime * 1000.0 / Frames,
+		TotalWorkTime * 1000.0 / Frames,
+		TotalSimTicks > 0 ? FPlatformTime::ToMilliseconds64(TotalSimCycles) * 1000.0 / TotalSimTicks : 0.0,
+		NumStateSamples > 0 ? TotalStateBits / NumStateSamples : 0.0,
+		TotalInBytes / 1024.0 / RunTime,
+		TotalOutBytes / 1024.0 / RunTime);
+
+	if (bSaved)
+	{
+		UE_LOG(LogVortexMover, Log, TEXT("Load test: wrote %s"), *FileName);
+	}
+	else
+	{
+		UE_LOG(LogVortexMover, Warning, TEXT("Load test: failed to write %s"), *FileName);
+	}
+}
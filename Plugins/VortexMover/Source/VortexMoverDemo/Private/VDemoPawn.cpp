@@ -3,13 +3,15 @@
 
 #include "VDemoPawn.h"
 
+#include "VDemoInputData.h"
 #include "VDemoPlayerController.h"
 #include "Components/CapsuleComponent.h"
 #include "Core/VortexInputProducer.h"
 #include "Core/VortexMoverComponent.h"
 #include "Mover/Public/DefaultMovementSet/CharacterMoverComponent.h"
 
-AVDemoPawn::AVDemoPawn()
+AVDemoPawn::AVDemoPawn(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
 	PrimaryActorTick.bCanEverTick = false;
 
@@ -44,6 +46,18 @@ void AVDemoPawn::PostInitializeComponents()
 	InputProducer->Initialize(this);
 }
 
+float AVDemoPawn::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	const float Priority = Super::GetNetPriority(ViewPos, ViewDir, Viewer, ViewTarget, InChannel, Time, bLowBandwidth);
+
+	// Generic replication only, Iris does not call GetNetPriority. A viewer always gets its own pawn at full priority.
+	if (Viewer == this || ViewTarget == this || !MoverComponent)
+	{
+		return Priority;
+	}
+	return Priority * MoverComponent->GetNetPriorityScale(ViewPos, ViewDir);
+}
+
 void AVDemoPawn::OnRep_Controller()
 {
 	Super::OnRep_Controller();
@@ -66,6 +80,16 @@ void AVDemoPawn::BindControllerInput()
 	{
 		DemoController = PC;
 
+		// Polled producers read the held values themselves, but still need the events below: they carry press and release
+		// edges shorter than a frame, and are all the producer has when Mover asks for input off the game thread
+		if (IsValid(InputProducer) && InputProducer->GetSamplingMode() == EVortexInputSamplingMode::Polled)
+		{
+			if (const UVDemoInputData* InputData = PC->GetInputMappingData())
+			{
+				InputProducer->SetPolledInputActions(InputData->MoveAction, InputData->LookAction, InputData->JumpAction, InputData->CrouchAction);
+			}
+		}
+
 		LookInputDelegateHandle = PC->OnInputLook.AddWeakLambda(this, [this](const FInputActionValue& Value)
 		{
 			if (IsValid(InputProducer))
@@ -30,7 +30,9 @@ void AVDemoPlayerController::SetupInputComponent()
 	{
 		if (InputMappingData->MoveAction)
 		{
+			// Completed delivers the release, Triggered stops firing once the action is no longer actuated
 			EIC->BindAction(InputMappingData->MoveAction, ETriggerEvent::Triggered, this, &ThisClass::OnMove);
+			EIC->BindAction(InputMappingData->MoveAction, ETriggerEvent::Completed, this, &ThisClass::OnMove);
 		}
 		if (InputMappingData->LookAction)
 		{
@@ -39,10 +41,12 @@ void AVDemoPlayerController::SetupInputComponent()
 		if (InputMappingData->JumpAction)
 		{
 			EIC->BindAction(InputMappingData->JumpAction, ETriggerEvent::Triggered, this, &ThisClass::OnJump);
+			EIC->BindAction(InputMappingData->JumpAction, ETriggerEvent::Completed, this, &ThisClass::OnJump);
 		}
 		if (InputMappingData->CrouchAction)
 		{
 			EIC->BindAction(InputMappingData->CrouchAction, ETriggerEvent::Triggered, this, &ThisClass::OnCrouch);
+			EIC->BindAction(InputMappingData->CrouchAction, ETriggerEvent::Completed, this, &ThisClass::OnCrouch);
 		}
 	}
 }
@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VDemoPawn.h"
+#include "VDemoBotPawn.generated.h"
+
+/**
+ * AVDemoBotPawn
+ *
+ * -AVDemoPawn driven by a UVortexScriptedInputProducer instead of a player, for load tests
+ * -Server owned, needs no controller: Mover asks the scripted producer for input directly
+ */
+UCLASS()
+class VORTEXMOVERDEMO_API AVDemoBotPawn : public AVDemoPawn
+{
+	GENERATED_BODY()
+
+public:
+	AVDemoBotPawn(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
+
+	// Selects the random input pattern, call before the first simulation tick
+	void SetInputSeed(int32 Seed);
+};
@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "VDemoLoadTestSubsystem.generated.h"
+
+class AVDemoBotPawn;
+
+/**
+ * UVDemoLoadTestSubsystem
+ *
+ * -Spawns N AVDemoBotPawns on the server and records server cost while they move, one CSV row per second
+ * -Columns: frame time (total and without idle wait), movement simulation cost per pawn tick, serialized size of each bot's
+ *  Vortex state (proxy state and input command), net bandwidth in/out. Bandwidth is only measured with connected clients,
+ *  a headless server on its own reports 0.
+ * -CSV goes to Saved/Profiling/VortexLoadTest, a summary is logged when the run ends
+ * -A console command and command line switch, not a commandlet or automation test
+ * -Headless: Server L_TestArea -server -nullrhi -VortexLoadTest=<Bots> [-VortexLoadTestDuration=<s>] [-VortexLoadTestSeed=<n>]
+ *  starts when the map begins play and exits the process when done
+ * -Interactive: vortex.loadtest.Start <Bots> [Duration] [Seed], vortex.loadtest.Stop
+ */
+UCLASS()
+class VORTEXMOVERDEMO_API UVDemoLoadTestSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Server only, restarts the run if one is active
+	void StartLoadTest(int32 NumBots, float Duration, int32 Seed, bool bExitWhenDone = false);
+	void StopLoadTest();
+
+	bool IsRunning() const { return bRunning; }
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	void SpawnBots(int32 NumBots, int32 Seed);
+	void DestroyBots();
+	void FlushSample();
+	void WriteReport();
+
+	// Seconds per CSV row
+	static constexpr double SampleInterval = 1.0;
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AVDemoBotPawn>> Bots;
+
+	bool bRunning = false;
+	bool bExitWhenDone = false;
+	double Duration = 0.0;
+	double StartTime = 0.0;
+	double SampleStartTime = 0.0;
+
+	// Current sample
+	int32 SampleFrames = 0;
+	double SampleFrameTime = 0.0;
+	double SampleFrameTimeMax = 0.0;
+	double SampleWorkTime = 0.0;
+
+	// Whole run
+	int32 TotalFrames = 0;
+	double TotalFrameTime = 0.0;
+	double TotalWorkTime = 0.0;
+	uint64 TotalSimCycles = 0;
+	uint64 TotalSimTicks = 0;
+	uint64 TotalInBytes = 0;
+	uint64 TotalOutBytes = 0;
+	double TotalStateBits = 0.0;
+	int32 NumStateSamples = 0;
+
+	TArray<FString> CsvLines;
+};
@@ -24,10 +24,13 @@ class VORTEXMOVERDEMO_API AVDemoPawn : public APawn
 	GENERATED_BODY()
 
 public:
-	AVDemoPawn();
+	AVDemoPawn(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 	virtual void PossessedBy(AController* NewController) override;
 	virtual void UnPossessed() override;
 	virtual void Tick(float DeltaTime) override;
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, AActor* Viewer, AActor* ViewTarget, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	UVortexInputProducer* GetInputProducer() const { return InputProducer; }
 
 protected:
 	virtual void BeginPlay() override;
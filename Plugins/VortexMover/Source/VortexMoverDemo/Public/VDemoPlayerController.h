@@ -30,6 +30,8 @@ public:
 	FOnInputMoveSignature OnInputMove;
 	FOnInputJumpSignature OnInputJump;
 	FOnInputCrouchSignature OnInputCrouch;
+
+	const UVDemoInputData* GetInputMappingData() const { return InputMappingData; }
 	
 protected:
 	virtual void SetupInputComponent() override;